@@ -0,0 +1,458 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/all.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// vsgpagingbenchmark generates a synthetic PagedLOD quadtree database on disk and replays scripted camera paths over it, driving the
+// RecordTraversal and DatabasePager::updateSceneGraph() each frame without a window. DatabasePager::compileTraversal is left null so
+// the compile stage is skipped and no Vulkan device is required, allowing the benchmark to run headless on a CI machine without a GPU.
+// The --update-scaling mode instead measures the per frame cost of DatabasePager::updateSceneGraph() against the number of resident tiles.
+
+struct DatabaseSettings
+{
+    vsg::Path path = "vsgpagingbenchmark_database";
+    std::string extension = "vsgb";
+    uint32_t numLevels = 5;
+    double extent = 100000.0;     // half width of the root tile
+    uint32_t tileDataSize = 65536; // bytes of Data in each tile
+    double minimumScreenHeightRatio = 0.5;
+};
+
+vsg::Path tileFilename(const DatabaseSettings& settings, uint32_t level, uint32_t x, uint32_t y)
+{
+    return vsg::make_string("tile_", level, "_", x, "_", y, ".", settings.extension);
+}
+
+// tile content is a StateGroup referencing Data so the DatabasePager's memory accounting has something to measure, it has no Commands so nothing is recorded.
+vsg::ref_ptr<vsg::Node> createTileContent(const DatabaseSettings& settings)
+{
+    auto data = vsg::floatArray::create(std::max(settings.tileDataSize / static_cast<uint32_t>(sizeof(float)), 1u));
+    std::fill(data->begin(), data->end(), 1.0f);
+
+    auto descriptorSet = vsg::DescriptorSet::create(vsg::ref_ptr<vsg::DescriptorSetLayout>(), vsg::Descriptors{vsg::DescriptorBuffer::create(data)});
+
+    auto stateGroup = vsg::StateGroup::create();
+    stateGroup->add(vsg::BindDescriptorSet::create(VK_PIPELINE_BIND_POINT_GRAPHICS, nullptr, descriptorSet.get()));
+    return stateGroup;
+}
+
+// PagedLOD for a tile with its low resolution content resident and its high resolution children loaded from the tile's file.
+vsg::ref_ptr<vsg::PagedLOD> createTile(const DatabaseSettings& settings, uint32_t level, uint32_t x, uint32_t y)
+{
+    double size = 2.0 * settings.extent / static_cast<double>(1u << level);
+
+    auto plod = vsg::PagedLOD::create();
+    plod->setBound(vsg::dsphere(-settings.extent + (x + 0.5) * size, -settings.extent + (y + 0.5) * size, 0.0, size * 0.5 * std::sqrt(2.0)));
+
+    auto& highRes = plod->getChild(0);
+    highRes.minimumScreenHeightRatio = settings.minimumScreenHeightRatio;
+    highRes.filename = tileFilename(settings, level, x, y);
+
+    auto& lowRes = plod->getChild(1);
+    lowRes.minimumScreenHeightRatio = 0.0;
+    lowRes.node = createTileContent(settings);
+
+    return plod;
+}
+
+// write the file holding the four high resolution children of a tile, then recursively the files of those children.
+bool writeTile(const DatabaseSettings& settings, uint32_t level, uint32_t x, uint32_t y, uint32_t& numFiles)
+{
+    auto group = vsg::Group::create();
+    for (uint32_t j = 0; j < 2; ++j)
+    {
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            uint32_t cx = x * 2 + i;
+            uint32_t cy = y * 2 + j;
+            if ((level + 1) < settings.numLevels)
+            {
+                group->addChild(createTile(settings, level + 1, cx, cy));
+                if (!writeTile(settings, level + 1, cx, cy, numFiles)) return false;
+            }
+            else
+            {
+                group->addChild(createTileContent(settings));
+            }
+        }
+    }
+
+    ++numFiles;
+    return vsg::write(group, vsg::concatPaths(settings.path, tileFilename(settings, level, x, y)));
+}
+
+struct CameraPath
+{
+    std::string name;
+
+    // set the eye and look at centre for a normalized path time in the range 0 to 1, the ground is the z=0 plane.
+    std::function<void(double, vsg::dvec3&, vsg::dvec3&)> position;
+};
+
+std::vector<CameraPath> createCameraPaths(double extent)
+{
+    std::vector<CameraPath> cameraPaths;
+
+    // descend from above the whole database to ground level, progressively requiring every level of the quadtree
+    cameraPaths.push_back(CameraPath{"descend", [extent](double t, vsg::dvec3& eye, vsg::dvec3& centre) {
+                                         double altitude = extent * 2.0 * std::pow(0.001, t);
+                                         eye.set(extent * 0.3, extent * 0.2, altitude);
+                                         centre.set(extent * 0.3, extent * 0.2 + altitude, 0.0);
+                                     }});
+
+    // fly across the database at low altitude, continuously requesting new high resolution tiles and expiring those left behind
+    cameraPaths.push_back(CameraPath{"flyover", [extent](double t, vsg::dvec3& eye, vsg::dvec3& centre) {
+                                         double altitude = extent * 0.01;
+                                         double x = extent * (-0.8 + 1.6 * t);
+                                         eye.set(x, extent * -0.1, altitude);
+                                         centre.set(x + altitude * 2.0, extent * -0.1, 0.0);
+                                     }});
+
+    // jump between distant low altitude viewpoints, the last jump is made as the path ends so the time to full resolution measures how quickly a completely new view is loaded
+    cameraPaths.push_back(CameraPath{"jump", [extent](double t, vsg::dvec3& eye, vsg::dvec3& centre) {
+                                         const double viewpoints[4][2] = {{-0.5, -0.5}, {0.6, 0.1}, {-0.2, 0.7}, {0.4, -0.6}};
+                                         auto& viewpoint = viewpoints[std::min(static_cast<int>(t * 3.0), 3)];
+                                         double altitude = extent * 0.005;
+                                         eye.set(extent * viewpoint[0], extent * viewpoint[1], altitude);
+                                         centre.set(extent * viewpoint[0], extent * viewpoint[1] + altitude * 2.0, 0.0);
+                                     }});
+
+    return cameraPaths;
+}
+
+struct FrameTimes
+{
+    std::vector<double> times; // milliseconds
+
+    void add(vsg::time_point start, vsg::time_point end) { times.push_back(std::chrono::duration<double, std::chrono::milliseconds::period>(end - start).count()); }
+
+    double average() const
+    {
+        if (times.empty()) return 0.0;
+        double total = 0.0;
+        for (auto time : times) total += time;
+        return total / static_cast<double>(times.size());
+    }
+
+    double percentile(double ratio) const
+    {
+        if (times.empty()) return 0.0;
+        auto sorted = times;
+        auto nth = sorted.begin() + static_cast<std::ptrdiff_t>(ratio * static_cast<double>(sorted.size() - 1));
+        std::nth_element(sorted.begin(), nth, sorted.end());
+        return *nth;
+    }
+
+    double maximum() const { return times.empty() ? 0.0 : *std::max_element(times.begin(), times.end()); }
+
+    void print(std::ostream& out, const char* name) const
+    {
+        out << "    " << std::setw(8) << std::left << name << std::right << " average " << average() << "ms, 99th percentile " << percentile(0.99) << "ms, maximum " << maximum() << "ms" << std::endl;
+    }
+};
+
+struct BenchmarkSettings
+{
+    double duration = 10.0; // seconds of camera motion along each path, after which the camera holds at its final position
+    double frameRate = 60.0;
+    double maxSettleTime = 30.0; // seconds after the camera stops before giving up on reaching full resolution
+    uint32_t numReadThreads = 4;
+    uint32_t maxNumTiles = 10000; // DatabasePager::targetMaxNumPagedLODWithHighResSubgraphs, lower values exercise expiry
+    double prefetchTime = 0.0;
+    uint32_t cacheSize = 0; // MB of DatabasePager::subgraphCache, 0 disables the cache
+    double fieldOfView = 60.0; // degrees
+    double aspectRatio = 16.0 / 9.0;
+};
+
+// replay a camera path over the database, returns false if full resolution wasn't reached within maxSettleTime of the camera stopping.
+bool runCameraPath(const vsg::Path& rootFilename, const DatabaseSettings& databaseSettings, const BenchmarkSettings& settings, const CameraPath& cameraPath)
+{
+    // read the root for each path so that every path starts with no high resolution tiles loaded
+    auto scene = vsg::read_cast<vsg::Node>(rootFilename);
+    if (!scene)
+    {
+        std::cout << "Unable to read " << rootFilename << std::endl;
+        return false;
+    }
+
+    auto databasePager = vsg::DatabasePager::create();
+    databasePager->numReadThreads = settings.numReadThreads;
+    databasePager->targetMaxNumPagedLODWithHighResSubgraphs = settings.maxNumTiles;
+    databasePager->prefetchTime = settings.prefetchTime;
+    if (settings.cacheSize > 0) databasePager->subgraphCache = vsg::SubgraphCache::create(static_cast<uint64_t>(settings.cacheSize) * 1024 * 1024);
+    databasePager->start();
+
+    // no CommandBuffer is required as the database contains no Commands
+    vsg::RecordTraversal recordTraversal;
+    recordTraversal.databasePager = databasePager;
+    recordTraversal.culledPagedLODs = databasePager->culledPagedLODs;
+
+    auto projectionMatrix = vsg::perspective(vsg::radians(settings.fieldOfView), settings.aspectRatio, 1.0, databaseSettings.extent * 10.0);
+    vsg::dvec3 up(0.0, 0.0, 1.0);
+    vsg::dvec3 eye, centre, previous_eye;
+
+    auto frameDuration = std::chrono::duration_cast<vsg::clock::duration>(std::chrono::duration<double>(1.0 / settings.frameRate));
+    auto startTime = vsg::clock::now();
+    vsg::time_point stopTime;
+    uint64_t stopFrame = 0;
+    bool cameraStopped = false;
+    double timeToFullResolution = -1.0;
+    uint64_t framesToFullResolution = 0;
+    uint64_t framesBelowFullResolution = 0;
+
+    FrameTimes recordTimes, updateTimes;
+    uint64_t peakCPUMemoryUsage = 0;
+    uint32_t peakNumResidentTiles = 0;
+
+    uint64_t frameCount = 0;
+    for (; !cameraStopped || (vsg::clock::now() - stopTime) < std::chrono::duration<double>(settings.maxSettleTime); ++frameCount)
+    {
+        // pace frames to the frame rate so the pager threads get the same time per frame as they would in an application
+        auto frameTime = startTime + frameDuration * frameCount;
+        std::this_thread::sleep_until(frameTime);
+
+        double t = std::chrono::duration<double>(frameTime - startTime).count() / settings.duration;
+        if (t >= 1.0 && !cameraStopped)
+        {
+            cameraStopped = true;
+            stopTime = frameTime;
+            stopFrame = frameCount;
+        }
+
+        cameraPath.position(std::min(t, 1.0), eye, centre);
+
+        // extrapolate the camera motion for prefetching in the same way as RenderGraph
+        if (settings.prefetchTime > 0.0 && frameCount > 0)
+        {
+            auto viewRotation = vsg::lookAt(eye, centre, up);
+            auto velocity = (eye - previous_eye) * settings.frameRate * settings.prefetchTime;
+            recordTraversal.prefetch = true;
+            recordTraversal.prefetchEyeOffset.set(viewRotation[0][0] * velocity.x + viewRotation[1][0] * velocity.y + viewRotation[2][0] * velocity.z,
+                                                  viewRotation[0][1] * velocity.x + viewRotation[1][1] * velocity.y + viewRotation[2][1] * velocity.z,
+                                                  viewRotation[0][2] * velocity.x + viewRotation[1][2] * velocity.y + viewRotation[2][2] * velocity.z);
+        }
+        previous_eye.set(eye.x, eye.y, eye.z);
+
+        auto frameStamp = vsg::FrameStamp::create(vsg::clock::now(), frameCount);
+
+        auto beforeRecord = vsg::clock::now();
+        recordTraversal.frameStamp = frameStamp;
+        recordTraversal.setProjectionAndViewMatrix(projectionMatrix, vsg::lookAt(eye, centre, up));
+        scene->accept(recordTraversal);
+        auto afterRecord = vsg::clock::now();
+
+        // frames recorded with outstanding requests are drawing lower resolution tiles in place of those still being loaded,
+        // once the camera has stopped, full resolution is reached by the first frame recorded without any outstanding requests
+        bool fullResolution = databasePager->numActiveRequests.load() == 0;
+        if (!fullResolution) ++framesBelowFullResolution;
+
+        databasePager->updateSceneGraph(frameStamp);
+        auto afterUpdate = vsg::clock::now();
+
+        recordTimes.add(beforeRecord, afterRecord);
+        updateTimes.add(afterRecord, afterUpdate);
+
+        peakCPUMemoryUsage = std::max(peakCPUMemoryUsage, databasePager->getCPUMemoryUsage());
+        peakNumResidentTiles = std::max(peakNumResidentTiles, databasePager->pagedLODContainer->activeList.count + databasePager->pagedLODContainer->inactiveList.count);
+
+        if (cameraStopped && fullResolution)
+        {
+            timeToFullResolution = std::chrono::duration<double>(afterRecord - stopTime).count();
+            framesToFullResolution = frameCount - stopFrame;
+            break;
+        }
+    }
+
+    auto& statistics = *databasePager->statistics;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "camera path " << cameraPath.name << ", " << frameCount << " frames, " << framesBelowFullResolution << " recorded below full resolution" << std::endl;
+    if (timeToFullResolution >= 0.0)
+        std::cout << "    time to full resolution " << timeToFullResolution << "s, " << framesToFullResolution << " frames after the camera stopped" << std::endl;
+    else
+        std::cout << "    full resolution not reached within " << settings.maxSettleTime << "s of the camera stopping" << std::endl;
+    recordTimes.print(std::cout, "record");
+    updateTimes.print(std::cout, "update");
+    std::cout << "    peak CPU memory " << static_cast<double>(peakCPUMemoryUsage) / (1024.0 * 1024.0) << "MB, peak resident tiles " << peakNumResidentTiles << std::endl;
+    std::cout << "    requests " << statistics.numRequests << ", merged " << statistics.numMerged << ", discarded " << statistics.numDiscarded << ", expired " << statistics.numExpired << ", cache hits " << statistics.numCacheHits << std::endl;
+    std::cout << "    read average " << statistics.read.average() * 1000.0 << "ms, maximum " << static_cast<double>(statistics.read.maximum) * 1e-3 << "ms" << std::endl;
+
+    return timeToFullResolution >= 0.0;
+}
+
+struct UpdateScalingSettings
+{
+    std::vector<uint32_t> tileCounts = {1000, 4000, 16000, 64000};
+    std::vector<uint64_t> activeRefreshIntervals = {1, 16}; // an interval of 1 moves every tile in use each frame, as costly as walking the whole activeList
+    uint32_t numFrames = 256;
+};
+
+// measure updateSceneGraph() with a grid of in memory PagedLOD whose high resolution children are all resident and in view, so the cost is
+// that of the PagedLODContainer bookkeeping alone. Tiles in continuous use are moved to the tail of the activeList every activeRefreshInterval
+// frames, so with the default interval the cost should grow far slower than the resident tile count.
+void runUpdateScaling(const UpdateScalingSettings& settings)
+{
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "update scaling, " << settings.numFrames << " frames per run" << std::endl;
+    std::cout << "    resident tiles, refresh interval, moved per frame, update average ms, update maximum ms, record average ms" << std::endl;
+
+    for (auto activeRefreshInterval : settings.activeRefreshIntervals)
+    {
+        for (auto tileCount : settings.tileCounts)
+        {
+            uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(tileCount))));
+            double tileSize = 1.0;
+            double halfWidth = 0.5 * tileSize * static_cast<double>(gridSize);
+
+            auto scene = vsg::Group::create();
+            std::vector<vsg::ref_ptr<vsg::PagedLOD>> tiles;
+            for (uint32_t i = 0; i < tileCount; ++i)
+            {
+                auto plod = vsg::PagedLOD::create();
+                plod->setBound(vsg::dsphere(-halfWidth + ((i % gridSize) + 0.5) * tileSize, -halfWidth + ((i / gridSize) + 0.5) * tileSize, 0.0, tileSize * 0.5));
+
+                // a minimumScreenHeightRatio of 0 keeps the high resolution child selected, its filename is assigned as the tile becomes resident
+                auto& highRes = plod->getChild(0);
+                highRes.minimumScreenHeightRatio = 0.0;
+                highRes.node = vsg::Group::create();
+
+                auto& lowRes = plod->getChild(1);
+                lowRes.minimumScreenHeightRatio = 0.0;
+                lowRes.node = vsg::Group::create();
+
+                scene->addChild(plod);
+                tiles.push_back(plod);
+            }
+
+            auto databasePager = vsg::DatabasePager::create();
+            databasePager->culledPagedLODs->activeRefreshInterval = activeRefreshInterval;
+
+            vsg::RecordTraversal recordTraversal;
+            recordTraversal.databasePager = databasePager;
+            recordTraversal.culledPagedLODs = databasePager->culledPagedLODs;
+
+            // look straight down on the whole grid
+            auto projectionMatrix = vsg::perspective(vsg::radians(60.0), 1.0, 0.1, halfWidth * 10.0);
+            auto viewMatrix = vsg::lookAt(vsg::dvec3(0.0, 0.0, halfWidth * 2.5), vsg::dvec3(0.0, 0.0, 0.0), vsg::dvec3(0.0, 1.0, 0.0));
+
+            FrameTimes recordTimes, updateTimes;
+            uint64_t numMoved = 0;
+
+            // the tiles become resident over the first activeRefreshInterval frames, as they would when loaded over time, so their refreshes are staggered
+            // across frames, the frames after that are measured.
+            uint64_t numResidencyFrames = std::max(activeRefreshInterval, uint64_t(1));
+            for (uint64_t frameCount = 1; frameCount <= numResidencyFrames + settings.numFrames; ++frameCount)
+            {
+                if (frameCount <= numResidencyFrames)
+                {
+                    for (size_t i = frameCount - 1; i < tiles.size(); i += numResidencyFrames)
+                    {
+                        tiles[i]->setFilename(tileFilename(DatabaseSettings(), 0, static_cast<uint32_t>(i % gridSize), static_cast<uint32_t>(i / gridSize)));
+                    }
+                }
+
+                auto frameStamp = vsg::FrameStamp::create(vsg::clock::now(), frameCount);
+
+                auto beforeRecord = vsg::clock::now();
+                recordTraversal.frameStamp = frameStamp;
+                recordTraversal.setProjectionAndViewMatrix(projectionMatrix, viewMatrix);
+                scene->accept(recordTraversal);
+                auto afterRecord = vsg::clock::now();
+
+                auto numToMove = databasePager->culledPagedLODs->newHighresRequired.size();
+
+                databasePager->updateSceneGraph(frameStamp);
+                auto afterUpdate = vsg::clock::now();
+
+                if (frameCount > numResidencyFrames)
+                {
+                    recordTimes.add(beforeRecord, afterRecord);
+                    updateTimes.add(afterRecord, afterUpdate);
+                    numMoved += numToMove;
+                }
+            }
+
+            uint32_t numResident = databasePager->pagedLODContainer->activeList.count;
+            std::cout << "    " << std::setw(14) << numResident << ", " << std::setw(16) << activeRefreshInterval << ", " << std::setw(15) << (numMoved / settings.numFrames) << ", "
+                      << std::setw(19) << updateTimes.average() << ", " << std::setw(19) << updateTimes.maximum() << ", " << std::setw(19) << recordTimes.average() << std::endl;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    vsg::CommandLine arguments(&argc, argv);
+
+    DatabaseSettings databaseSettings;
+    databaseSettings.path = arguments.value(databaseSettings.path, "--path");
+    databaseSettings.numLevels = arguments.value(databaseSettings.numLevels, "--levels");
+    databaseSettings.tileDataSize = arguments.value(databaseSettings.tileDataSize, "--tile-size");
+    databaseSettings.minimumScreenHeightRatio = arguments.value(databaseSettings.minimumScreenHeightRatio, "--ratio");
+    if (arguments.read("--ascii")) databaseSettings.extension = "vsgt";
+
+    BenchmarkSettings settings;
+    settings.duration = arguments.value(settings.duration, "--duration");
+    settings.frameRate = arguments.value(settings.frameRate, "--fps");
+    settings.maxSettleTime = arguments.value(settings.maxSettleTime, "--max-settle-time");
+    settings.numReadThreads = arguments.value(settings.numReadThreads, "--read-threads");
+    settings.maxNumTiles = arguments.value(settings.maxNumTiles, "--max-tiles");
+    settings.prefetchTime = arguments.value(settings.prefetchTime, "--prefetch");
+    settings.cacheSize = arguments.value(settings.cacheSize, "--cache");
+
+    auto pathName = arguments.value(std::string(), "--camera-path");
+
+    bool updateScaling = arguments.read("--update-scaling");
+    UpdateScalingSettings updateScalingSettings;
+    updateScalingSettings.numFrames = arguments.value(updateScalingSettings.numFrames, "--frames");
+
+    if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
+
+    if (updateScaling)
+    {
+        runUpdateScaling(updateScalingSettings);
+        return 0;
+    }
+
+    // generate the database
+    std::error_code errorCode;
+    std::filesystem::create_directories(databaseSettings.path, errorCode);
+
+    auto rootFilename = vsg::concatPaths(databaseSettings.path, vsg::make_string("root.", databaseSettings.extension));
+
+    auto startGeneration = vsg::clock::now();
+    uint32_t numFiles = 0;
+    if (!vsg::write(createTile(databaseSettings, 0, 0, 0), rootFilename) || !writeTile(databaseSettings, 0, 0, 0, numFiles))
+    {
+        std::cout << "Unable to write database to " << databaseSettings.path << std::endl;
+        return 1;
+    }
+    std::cout << "generated " << databaseSettings.numLevels << " level quadtree, " << numFiles << " tile files in " << std::chrono::duration<double>(vsg::clock::now() - startGeneration).count() << "s" << std::endl;
+
+    bool result = true;
+    for (auto& cameraPath : createCameraPaths(databaseSettings.extent))
+    {
+        if (!pathName.empty() && pathName != cameraPath.name) continue;
+
+        result = runCameraPath(rootFilename, databaseSettings, settings, cameraPath) && result;
+    }
+
+    return result ? 0 : 1;
+}
@@ -35,6 +35,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/core/type_name.h>
 
 // Maths header files
+#include <vsg/maths/batchIntersect.h>
 #include <vsg/maths/box.h>
 #include <vsg/maths/mat3.h>
 #include <vsg/maths/mat4.h>
@@ -47,6 +48,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/maths/vec4.h>
 
 // Node header files
+#include <vsg/nodes/BatchCullGroup.h>
 #include <vsg/nodes/Commands.h>
 #include <vsg/nodes/CullGroup.h>
 #include <vsg/nodes/CullNode.h>
@@ -64,13 +66,22 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/traversals/CompileTraversal.h>
 #include <vsg/traversals/ComputeBounds.h>
 #include <vsg/traversals/CullTraversal.h>
+#include <vsg/traversals/DrawList.h>
 #include <vsg/traversals/RecordTraversal.h>
+#include <vsg/traversals/traversePagedLOD.h>
 
 // Threading header files
 #include <vsg/threading/Affinity.h>
+#include <vsg/threading/Barrier.h>
+#include <vsg/threading/CPUTopology.h>
+#include <vsg/threading/Futex.h>
 #include <vsg/threading/Latch.h>
 #include <vsg/threading/OperationQueue.h>
 #include <vsg/threading/OperationThreads.h>
+#include <vsg/threading/Pipeline.h>
+#include <vsg/threading/RingBuffer.h>
+#include <vsg/threading/TaskScheduler.h>
+#include <vsg/threading/ThreadPriority.h>
 #include <vsg/threading/atomics.h>
 
 // User Interface abstraction header files
@@ -33,6 +33,7 @@ namespace vsg
     class StateGroup;
     class CullGroup;
     class CullNode;
+    class BatchCullGroup;
     class MatrixTransform;
     class Geometry;
     class VertexIndexDraw;
@@ -175,6 +176,7 @@ namespace vsg
         virtual void apply(const StateGroup&);
         virtual void apply(const CullGroup&);
         virtual void apply(const CullNode&);
+        virtual void apply(const BatchCullGroup&);
         virtual void apply(const MatrixTransform&);
         virtual void apply(const Geometry&);
         virtual void apply(const VertexIndexDraw&);
@@ -33,6 +33,7 @@ namespace vsg
     class StateGroup;
     class CullGroup;
     class CullNode;
+    class BatchCullGroup;
     class MatrixTransform;
     class Geometry;
     class VertexIndexDraw;
@@ -175,6 +176,7 @@ namespace vsg
         virtual void apply(StateGroup&);
         virtual void apply(CullGroup&);
         virtual void apply(CullNode&);
+        virtual void apply(BatchCullGroup&);
         virtual void apply(MatrixTransform&);
         virtual void apply(Geometry&);
         virtual void apply(VertexIndexDraw&);
@@ -19,11 +19,17 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/nodes/PagedLOD.h>
 
+#include <vsg/threading/Affinity.h>
 #include <vsg/threading/OperationQueue.h>
+#include <vsg/threading/Pipeline.h>
+#include <vsg/threading/ThreadPriority.h>
+#include <vsg/threading/atomics.h>
 
 #include <vsg/traversals/CompileTraversal.h>
 
+#include <array>
 #include <list>
+#include <map>
 #include <thread>
 
 namespace vsg
@@ -36,64 +42,263 @@ namespace vsg
         {
             highresCulled.reserve(512);
             newHighresRequired.reserve(8);
+            priorityIncreased.reserve(64);
         }
 
         void clear()
         {
             highresCulled.clear();
             newHighresRequired.clear();
+            priorityIncreased.clear();
         }
 
+        /// append the entries from another CulledPagedLODs, used to combine the results of RecordTraversals run in parallel.
+        void append(const CulledPagedLODs& rhs)
+        {
+            highresCulled.insert(highresCulled.end(), rhs.highresCulled.begin(), rhs.highresCulled.end());
+            newHighresRequired.insert(newHighresRequired.end(), rhs.newHighresRequired.begin(), rhs.newHighresRequired.end());
+            priorityIncreased.insert(priorityIncreased.end(), rhs.priorityIncreased.begin(), rhs.priorityIncreased.end());
+        }
+
+        /// number of frames between the RecordTraversal reporting a PagedLOD whose high res subgraph remains in continuous use via newHighresRequired.
+        /// The refreshed PagedLOD are moved to the tail of the PagedLODContainer::activeList, so the list stays ordered by PagedLOD::frameActiveRefreshed and
+        /// DatabasePager::updateSceneGraph() only needs to check the head of the list for PagedLOD that are no longer in use. Larger intervals reduce the
+        /// per frame cost at the expense of detecting inactive PagedLOD up to activeRefreshInterval frames later.
+        uint64_t activeRefreshInterval = 16;
+
         std::vector<const PagedLOD*> highresCulled;
-        std::vector<const PagedLOD*> newHighresRequired;
+        std::vector<const PagedLOD*> newHighresRequired; // newly required and refreshed PagedLOD
+        std::vector<const PagedLOD*> priorityIncreased;
     };
 
-    class VSG_DECLSPEC DatabaseQueue : public Inherit<Object, DatabaseQueue>
+    /// DatabaseQueue is a thread safe priority queue of PagedLOD, ordered so that take_when_avilable() returns the PagedLOD with the highest PagedLOD::priority.
+    /// It's the StageQueue used by the DatabasePager's read and compile PipelineStage, so threads adding PagedLOD, such as the RecordTraversal calling
+    /// DatabasePager::request(), don't contend on the queue's mutex.
+    class VSG_DECLSPEC DatabaseQueue : public Inherit<StageQueue<PagedLOD>, DatabaseQueue>
     {
     public:
         DatabaseQueue(ref_ptr<Active> in_active);
 
-        using Nodes = std::list<ref_ptr<PagedLOD>>;
+        using Nodes = Items;
 
-        Active* getActive() { return _active; }
-        const Active* getActive() const { return _active; }
+        ref_ptr<PagedLOD> take_when_avilable() { return take_when_available(); }
 
-        void add(ref_ptr<PagedLOD> plod);
+    protected:
+        virtual ~DatabaseQueue();
+    };
+    VSG_type_name(vsg::DatabaseQueue);
 
-        // add the plod reference to the queue then set the plod parameter to nullptr to ensure calling thread can't delete it
-        void add_then_reset(ref_ptr<PagedLOD>& plod);
+    /// DatabasePagerStatistics collects the paging statistics of a DatabasePager, cheap enough to leave enabled.
+    /// Counters and durations are cumulative and updated by the pager threads, the queue depths and list sizes are sampled at the end of each DatabasePager::updateSceneGraph().
+    /// All members are atomic so the statistics can be polled from any thread, typically once per frame after updateSceneGraph().
+    class VSG_DECLSPEC DatabasePagerStatistics : public Inherit<Object, DatabasePagerStatistics>
+    {
+    public:
+        DatabasePagerStatistics() {}
+
+        struct Duration
+        {
+            std::atomic_uint64_t count{0};
+            std::atomic_uint64_t total{0};   // microseconds
+            std::atomic_uint64_t maximum{0}; // microseconds
+
+            void add(uint64_t microseconds)
+            {
+                ++count;
+                total += microseconds;
+                exchange_if_greater(maximum, microseconds);
+            }
+
+            double average() const
+            {
+                uint64_t n = count.load();
+                return (n > 0) ? (double(total.load()) * 1e-6 / double(n)) : 0.0;
+            }
+        };
+
+        /// histogram of latencies with power of two millisecond bins, bin 0 is < 1ms, bin i is [2^(i-1), 2^i) ms and the last bin collects all longer latencies.
+        struct LatencyHistogram
+        {
+            static constexpr size_t numBins = 16;
+            std::array<std::atomic_uint64_t, numBins> bins{};
+
+            void add(double milliseconds)
+            {
+                size_t bin = 0;
+                for (double upper = 1.0; bin < (numBins - 1) && milliseconds >= upper; upper *= 2.0) ++bin;
+                ++bins[bin];
+            }
+        };
+
+        // durations of the pipeline stages
+        Duration read;    // reading a subgraph from file
+        Duration compile; // compile traversal of a subgraph
+        Duration merge;   // merging all the compiled subgraphs in a frame
+        Duration update;  // updating the PagedLODContainer active/inactive lists and expiring subgraphs in a frame
+
+        // time from the first request of a PagedLOD to its subgraph being merged and visible in the next frame
+        LatencyHistogram requestToMergeLatency;
+
+        std::atomic_uint64_t numRequests{0};
+        std::atomic_uint64_t numMerged{0};
+        std::atomic_uint64_t numBytesRead{0}; // size of the Data in the subgraphs read
+
+        // requests that have been cancelled because their PagedLOD were no longer required
+        std::atomic_uint64_t numReadRequestsCancelled{0};    // removed from the read queue before reading
+        std::atomic_uint64_t numReadsCancelled{0};           // subgraph read but discarded before compile
+        std::atomic_uint64_t numCompileRequestsCancelled{0}; // removed from the compile queue before compiling
+        std::atomic_uint64_t numDiscarded{0};                // all requests that completed without a merge, including the above
+        std::atomic_uint64_t numExpired{0};                  // merged subgraphs expired to meet the count and memory targets
+        std::atomic_uint64_t numCacheHits{0};                // requests satisfied from the DatabasePager::subgraphCache without reading
+
+        // sampled each frame by updateSceneGraph()
+        std::atomic_uint64_t frameCount{0};
+        std::atomic_uint32_t readQueueDepth{0};
+        std::atomic_uint32_t compileQueueDepth{0};
+        std::atomic_uint32_t mergeQueueDepth{0};
+        std::atomic_uint32_t numActiveRequests{0};
+        std::atomic_uint32_t activeListSize{0};
+        std::atomic_uint32_t inactiveListSize{0};
+        std::atomic_uint32_t numMergedLastFrame{0};
+        std::atomic_uint32_t numMergesDeferredLastFrame{0};
+        std::atomic_uint64_t cpuMemoryUsage{0};
+        std::atomic_uint64_t gpuMemoryUsage{0};
+        std::atomic_uint64_t cacheMemoryUsage{0};
 
-        void add(Nodes& nodes);
+    protected:
+        virtual ~DatabasePagerStatistics() {}
+    };
+    VSG_type_name(vsg::DatabasePagerStatistics);
 
-        ref_ptr<PagedLOD> take_when_avilable();
+    /// SubgraphCache is a thread safe least recently used cache of the subgraphs expired by the DatabasePager, keyed on the filename they were read from.
+    /// Cached subgraphs have their Vulkan buffers and images released so only occupy CPU memory, when memoryBudget is exceeded the least recently added subgraphs are discarded.
+    class VSG_DECLSPEC SubgraphCache : public Inherit<Object, SubgraphCache>
+    {
+    public:
+        SubgraphCache(uint64_t in_memoryBudget = 256 * 1024 * 1024);
 
-        Nodes take_all_when_available();
+        /// add subgraph, with its measured memory usage in bytes, replacing any previous entry for the same filename.
+        void add(const Path& filename, ref_ptr<Node> subgraph, uint64_t size);
 
-        Nodes take_all()
+        /// remove and return the subgraph cached for filename, size is set to its memory usage. Returns null if no subgraph is cached for filename.
+        ref_ptr<Node> take(const Path& filename, uint64_t& size);
+
+        void clear();
+
+        void setMemoryBudget(uint64_t budget);
+        uint64_t getMemoryBudget() const;
+
+        uint64_t getMemoryUsage() const;
+        size_t size() const;
+
+    protected:
+        virtual ~SubgraphCache();
+
+        struct Entry
         {
-            std::scoped_lock lock(_mutex);
-            Nodes nodes;
-            nodes.swap(_queue);
-            return nodes;
-        }
+            Path filename;
+            ref_ptr<Node> subgraph;
+            uint64_t size = 0;
+        };
+
+        using Entries = std::list<Entry>;
+
+        // discard the least recently added entries till the memory usage is within the budget, requires _mutex to be locked by the caller.
+        // Discarded entries are moved to discarded so that they can be deleted after _mutex is unlocked.
+        void _trim(Entries& discarded);
+
+        mutable std::mutex _mutex;
+        uint64_t _memoryBudget = 0;
+        uint64_t _memoryUsage = 0;
+        Entries _entries; // least recently added at the front
+        std::map<Path, Entries::iterator> _entryMap;
+    };
+    VSG_type_name(vsg::SubgraphCache);
+
+    /// PagingPriorityParameters are computed by the RecordTraversal for each request of a PagedLOD external child and passed to the PagingPriorityPolicy.
+    struct PagingPriorityParameters
+    {
+        const PagedLOD* plod = nullptr;
+        uint32_t childIndex = 0;
+        double screenHeightRatio = 0.0;      // ratio of the PagedLOD bounding sphere's projected size to the child's minimum, > 1.0 when the child is required
+        double screenSpaceError = 0.0;       // geometricError of the child drawn in the requested child's place, projected into units of half the viewport height, 0.0 when not known
+        double distanceFromViewCentre = 0.0; // distance of the bounding sphere centre from the centre of the view in normalized device coordinates, 0.0 at the centre and 1.0 at the edges
+        double timeRequested = 0.0;          // seconds since the PagedLOD was first requested, 0.0 for a new request
+    };
+
+    /// PagingPriorityPolicy computes the priority of PagedLOD requests, higher priority requests are read and compiled first.
+    /// The default implementation uses the screenHeightRatio alone, subclass and assign to DatabasePager::priorityPolicy to customize.
+    class VSG_DECLSPEC PagingPriorityPolicy : public Inherit<Object, PagingPriorityPolicy>
+    {
+    public:
+        virtual double priority(const PagingPriorityParameters& parameters) const;
 
     protected:
-        virtual ~DatabaseQueue();
+        virtual ~PagingPriorityPolicy() {}
+    };
+    VSG_type_name(vsg::PagingPriorityPolicy);
 
-        std::mutex _mutex;
-        std::condition_variable _cv;
-        Nodes _queue;
-        ref_ptr<Active> _active;
+    /// ScreenSpaceErrorPriorityPolicy prioritizes the requests that reduce the largest screen space error, falling back to the screenHeightRatio for PagedLOD without a geometricError,
+    /// weighted towards PagedLOD near the centre of the view and those that have been waiting the longest.
+    class VSG_DECLSPEC ScreenSpaceErrorPriorityPolicy : public Inherit<PagingPriorityPolicy, ScreenSpaceErrorPriorityPolicy>
+    {
+    public:
+        /// screen space error, in units of half the viewport height, that is acceptable to draw. The screenSpaceError is divided by it so that, like the screenHeightRatio,
+        /// values > 1.0 need refining and requests with and without a geometricError are prioritized on the same scale. The default is about 2 pixels on a 1080 pixel high viewport.
+        double maximumScreenSpaceError = 0.004;
+
+        /// additional weight given to requests at the centre of the view relative to those at the edges.
+        double viewCentreWeight = 1.0;
+
+        /// additional weight given to requests for each second they have been waiting.
+        double timeRequestedWeight = 0.5;
+
+        double priority(const PagingPriorityParameters& parameters) const override;
+
+    protected:
+        virtual ~ScreenSpaceErrorPriorityPolicy() {}
     };
-    VSG_type_name(vsg::DatabaseQueue);
+    VSG_type_name(vsg::ScreenSpaceErrorPriorityPolicy);
 
     class DatabasePager : public Inherit<Object, DatabasePager>
     {
     public:
         DatabasePager();
 
+        /// start the read and compile threads, the thread settings below should be set before start() is called.
         virtual void start();
 
+        /// number of threads used to read PagedLOD subgraphs, when adaptiveThreading is enabled this is the minimum number of threads used.
+        uint32_t numReadThreads = 4;
+
+        /// number of threads used to compile PagedLOD subgraphs, when adaptiveThreading is enabled this is the minimum number of threads used.
+        uint32_t numCompileThreads = 1;
+
+        /// number of CompileTraversal contexts that each compile thread adds to the pool of contexts shared by the compile threads.
+        uint32_t numCompileContexts = 16;
+
+        /// CPU affinity assigned to the read and compile threads, an empty Affinity leaves the thread free to run on any CPU.
+        Affinity readAffinity;
+        Affinity compileAffinity;
+
+        /// priority class of the read and compile threads, applied as each thread starts. Both default to below the priority of the
+        /// threads recording and submitting frames so that heavy paging doesn't take CPU time from them on a loaded machine.
+        ThreadPriority readThreadPriority = ThreadPriority::Background;
+        ThreadPriority compileThreadPriority = ThreadPriority::Low;
+
+        /// when adaptiveThreading is true updateSceneGraph() adjusts the number of active read threads based on the measured
+        /// read latency and read queue depth, and the number of active compile threads based on the compile backlog.
+        bool adaptiveThreading = false;
+        uint32_t maxNumReadThreads = 16;
+        uint32_t maxNumCompileThreads = 4;
+        double targetReadQueueDrainTime = 0.1; // seconds
+        uint32_t targetCompileBacklogPerThread = 8;
+        uint32_t numFramesBeforeRetiringThread = 120;
+
+        /// current number of active read/compile threads
+        uint32_t getNumActiveReadThreads() const { return _readStage->getConcurrencyLimit(); }
+        uint32_t getNumActiveCompileThreads() const { return _compileStage->getConcurrencyLimit(); }
+
         virtual void request(ref_ptr<PagedLOD> plod);
 
         virtual void updateSceneGraph(FrameStamp* frameStamp);
@@ -103,15 +308,54 @@ namespace vsg
 
         ref_ptr<const Options> options;
 
+        /// CompileTraversal that the compile threads' contexts are copied from, when null the compile stage is skipped
+        /// so loaded subgraphs are merged without being compiled, useful for running the pager without a Vulkan device.
         ref_ptr<CompileTraversal> compileTraversal;
 
         std::atomic_uint numActiveRequests{0};
         std::atomic_uint64_t frameCount;
 
+        /// when true updateSceneGraph() removes queued read and compile requests for PagedLOD that are no longer required.
+        bool cancelStaleRequests = true;
+
+        /// paging statistics, updated by the pager threads and updateSceneGraph().
+        ref_ptr<DatabasePagerStatistics> statistics;
+
         ref_ptr<CulledPagedLODs> culledPagedLODs;
 
+        /// time in seconds that the camera motion is extrapolated ahead by when checking which PagedLOD high res subgraphs will soon be required, 0.0 disables prefetching.
+        double prefetchTime = 0.0;
+
+        /// scale applied to the priority of prefetch requests so that they are read after the subgraphs required by the current view.
+        double prefetchPriorityScale = 0.1;
+
+        /// policy used by the RecordTraversal to compute the priority of requests, defaults to PagingPriorityPolicy.
+        ref_ptr<PagingPriorityPolicy> priorityPolicy;
+
         uint32_t targetMaxNumPagedLODWithHighResSubgraphs = 10000;
 
+        /// memory budgets, in bytes, for the high res subgraphs loaded by the pager. When a budget is exceeded the least recently used inactive subgraphs are expired first.
+        /// A value of 0 disables the respective budget so that only targetMaxNumPagedLODWithHighResSubgraphs is used.
+        uint64_t cpuMemoryBudget = 0;
+        uint64_t gpuMemoryBudget = 0;
+
+        /// optional cache that expired subgraphs are moved into rather than being deleted, so that a subsequent request for them can skip the read stage.
+        /// When null, the default, expired subgraphs are deleted.
+        ref_ptr<SubgraphCache> subgraphCache;
+
+        /// measured memory usage of the high res subgraphs currently merged into the scene graph.
+        uint64_t getCPUMemoryUsage() const { return _cpuMemoryUsage; }
+        uint64_t getGPUMemoryUsage() const { return _gpuMemoryUsage; }
+
+        /// per frame budgets for merging compiled subgraphs into the scene graph, subgraphs beyond the budget are left in the merge queue
+        /// and merged in subsequent frames in priority order. A value of 0 disables the respective budget.
+        uint32_t maxNumMergesPerFrame = 0;
+        double mergeTimeBudget = 0.0; // seconds, measured from the start of updateSceneGraph()
+
+        /// number of subgraphs merged, and the number of merges deferred to subsequent frames, by the last updateSceneGraph() call.
+        uint32_t getNumMerged() const { return _numMerged; }
+        uint32_t getNumMergesDeferred() const { return _numMergesDeferred; }
+
         std::mutex pendingPagedLODMutex;
 
         ref_ptr<PagedLODContainer> pagedLODContainer;
@@ -121,14 +365,55 @@ namespace vsg
 
         void requestDiscarded(PagedLOD* plod);
 
+        void cancelRequests();
+
+        void adaptThreads();
+
+        // pass a PagedLOD with a ReadRequest straight to the compile queue if its subgraph is in the subgraphCache, returns false if it isn't cached.
+        bool _requestFromCache(PagedLOD* plod);
+
+        // process functions of the read and compile PipelineStage, output is the queue of the following stage.
+        void _read(DatabaseQueue::Nodes& nodes, StageQueue<PagedLOD>& output);
+        void _compile(DatabaseQueue::Nodes& nodes, StageQueue<PagedLOD>& output);
+
+        // set the compile stage's concurrency limit, adding the CompileTraversal for any new compile threads to the pool.
+        void _setNumCompileThreads(uint32_t numThreads);
+
+        // pool of CompileTraversal shared by the compile threads, a CompileTraversal is returned to the pool by the completion thread once its transfers have completed.
+        ref_ptr<CompileTraversal> _takeCompileTraversal();
+        void _releaseCompileTraversal(ref_ptr<CompileTraversal> ct);
+        void _compileTraversalDispatched(ref_ptr<CompileTraversal> ct);
+        ref_ptr<CompileTraversal> _takeDispatchedCompileTraversal();
+
         ref_ptr<Active> _active;
 
         ref_ptr<DatabaseQueue> _requestQueue;
         ref_ptr<DatabaseQueue> _compileQueue;
         ref_ptr<DatabaseQueue> _toMergeQueue;
 
-        std::list<std::thread> _readThreads;
-        std::list<std::thread> _compileThreads;
+        ref_ptr<PipelineStage<PagedLOD>> _readStage;
+        ref_ptr<PipelineStage<PagedLOD>> _compileStage;
+        std::thread _completionThread;
+
+        std::mutex _compileTraversalMutex;
+        std::condition_variable _compileTraversalAvailable;
+        std::condition_variable _compileTraversalDispatchedCondition;
+        std::list<ref_ptr<CompileTraversal>> _availableCompileTraversals;
+        std::list<ref_ptr<CompileTraversal>> _dispatchedCompileTraversals;
+
+        // read timing used by adaptThreads()
+        uint64_t _previousReadDuration = 0;
+        uint64_t _previousNumReads = 0;
+        double _averageReadTime = 0.0; // seconds
+        uint32_t _numFramesReadQueueEmpty = 0;
+        uint32_t _numFramesCompileQueueEmpty = 0;
+
+        uint32_t _numMerged = 0;
+        uint32_t _numMergesDeferred = 0;
+
+        // memory usage of merged high res subgraphs, only updated by updateSceneGraph()
+        uint64_t _cpuMemoryUsage = 0;
+        uint64_t _gpuMemoryUsage = 0;
 
         Semaphores _semaphores;
     };
@@ -14,6 +14,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/core/Data.h>
 #include <vsg/core/Object.h>
+#include <vsg/core/Version.h>
 
 #include <vsg/maths/box.h>
 #include <vsg/maths/mat4.h>
@@ -34,6 +35,21 @@ namespace vsg
     // forward declare
     class Options;
 
+    /// version of the VSG library that wrote a file, used by Object::read(Input&) implementations to read the layout written by earlier versions.
+    struct VsgVersion
+    {
+        uint32_t majorVersion = VSG_VERSION_MAJOR;
+        uint32_t minorVersion = VSG_VERSION_MINOR;
+        uint32_t patchVersion = VSG_VERSION_PATCH;
+    };
+
+    inline bool operator<(const VsgVersion& lhs, const VsgVersion& rhs)
+    {
+        if (lhs.majorVersion != rhs.majorVersion) return lhs.majorVersion < rhs.majorVersion;
+        if (lhs.minorVersion != rhs.minorVersion) return lhs.minorVersion < rhs.minorVersion;
+        return lhs.patchVersion < rhs.patchVersion;
+    }
+
     class Input
     {
     public:
@@ -166,6 +182,12 @@ namespace vsg
         ref_ptr<const Options> options;
         Path filename;
 
+        /// version of the VSG library that wrote the stream, read from the file header. Defaults to the current version when there is no header.
+        VsgVersion version;
+
+        /// return true if the stream was written by a VSG version earlier than majorVersion.minorVersion.patchVersion
+        bool version_less(uint32_t majorVersion, uint32_t minorVersion, uint32_t patchVersion) const { return version < VsgVersion{majorVersion, minorVersion, patchVersion}; }
+
     protected:
         virtual ~Input();
     };
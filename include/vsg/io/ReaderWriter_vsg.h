@@ -12,6 +12,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/io/Input.h>
 #include <vsg/io/ReaderWriter.h>
 
 namespace vsg
@@ -39,6 +40,9 @@ namespace vsg
         };
 
         FormatType readHeader(std::istream& fin) const;
+
+        /// read the header, setting version to the VSG version that wrote the file.
+        FormatType readHeader(std::istream& fin, VsgVersion& version) const;
         void writeHeader(std::ostream& fout, FormatType type) const;
 
     protected:
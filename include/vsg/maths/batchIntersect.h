@@ -0,0 +1,29 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+
+#include <vsg/core/Export.h>
+#include <vsg/maths/plane.h>
+
+#include <cstdint>
+
+namespace vsg
+{
+
+    /** test count bounding spheres, stored as separate arrays of center x, y, z and radius values, against the convex polytope defined by numPlanes planes with normals pointing inwards.
+     *  The indices of the spheres that wholly or partially intersect the polytope are written in ascending order to visible, which must have room for count indices, and the number written is returned.
+     *  The spheres are tested several at a time using AVX, SSE2 or NEON instructions when the library is compiled with them enabled, falling back to testing one at a time. */
+    extern VSG_DECLSPEC uint32_t intersect(const dplane* planes, uint32_t numPlanes, const double* x, const double* y, const double* z, const double* radius, uint32_t count, uint32_t* visible);
+
+} // namespace vsg
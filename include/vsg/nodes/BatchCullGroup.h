@@ -0,0 +1,80 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+
+#include <vsg/maths/sphere.h>
+#include <vsg/nodes/Node.h>
+
+#include <vector>
+
+namespace vsg
+{
+
+    /** BatchCullGroup enables view frustum culling on each of its children, each child having its own bounding sphere.
+     *  The bounding spheres are stored as contiguous arrays of center x, y, z and radius values, so that the record and cull traversals can test
+     *  all of them against the view frustum in one batched call to vsg::intersect(..) and then only visit the children that are visible.
+     *  Use in place of a Group of CullNode/CullGroup when a subgraph has many culled children, such as the buildings of a city block.*/
+    class VSG_DECLSPEC BatchCullGroup : public Inherit<Node, BatchCullGroup>
+    {
+    public:
+        BatchCullGroup(Allocator* allocator = nullptr);
+
+        using Children = std::vector<ref_ptr<Node>>;
+
+        template<class N, class V>
+        static void t_traverse(N& node, V& visitor)
+        {
+            for (auto& child : node._children) child->accept(visitor);
+        }
+
+        void traverse(Visitor& visitor) override { t_traverse(*this, visitor); }
+        void traverse(ConstVisitor& visitor) const override { t_traverse(*this, visitor); }
+        void traverse(RecordTraversal& visitor) const override { t_traverse(*this, visitor); }
+        void traverse(CullTraversal& visitor) const override { t_traverse(*this, visitor); }
+
+        void read(Input& input) override;
+        void write(Output& output) const override;
+
+        void addChild(const dsphere& bound, ref_ptr<Node> child);
+
+        void setChild(std::size_t pos, const dsphere& bound, ref_ptr<Node> child);
+        Node* getChild(std::size_t pos) { return _children[pos]; }
+        const Node* getChild(std::size_t pos) const { return _children[pos]; }
+
+        void setBound(std::size_t pos, const dsphere& bound);
+        dsphere getBound(std::size_t pos) const { return dsphere(_centerX[pos], _centerY[pos], _centerZ[pos], _radius[pos]); }
+
+        std::size_t getNumChildren() const { return _children.size(); }
+
+        /// children are only modified via addChild() and setChild() so that the bounding sphere arrays stay in step with them.
+        const Children& getChildren() const { return _children; }
+
+        /// contiguous arrays of the children's bounding sphere centers and radii, in the same order as the children.
+        const double* getCenterX() const { return _centerX.data(); }
+        const double* getCenterY() const { return _centerY.data(); }
+        const double* getCenterZ() const { return _centerZ.data(); }
+        const double* getRadius() const { return _radius.data(); }
+
+    protected:
+        virtual ~BatchCullGroup();
+
+        Children _children;
+        std::vector<double> _centerX;
+        std::vector<double> _centerY;
+        std::vector<double> _centerZ;
+        std::vector<double> _radius;
+    };
+    VSG_type_name(vsg::BatchCullGroup);
+
+} // namespace vsg
@@ -17,9 +17,10 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/io/FileSystem.h>
 #include <vsg/io/Options.h>
 
+#include <vsg/ui/UIEvent.h>
 #include <vsg/vk/Semaphore.h>
 
-#include <array>
+#include <vector>
 
 namespace vsg
 {
@@ -33,6 +34,9 @@ namespace vsg
      *  During culling tHe visibleHeightRatio is used as a ratio of screen height that Bound sphere occupies on screen needs to be at least in order for the associated child to be traversed.
      *  Once on child passes this test no more children are checked, so that no more than on child will ever being traversed in a cull or dispatch traversal.
      *  If no PagedLODChild pass the visible height test then none of the PagedLOD's children will be visible.
+     *  Any number of children may be used, each child is either resident, or external when it has a filename in which case it is loaded by the DatabasePager when first required.
+     *  By default a PagedLOD has two children, the external high resolution child 0 set via setFilename() and the resident low resolution child 1, matching the original PagedLOD.
+     *  Whilst an external child is being loaded the next visible child is traversed in its place.
      *  During the cull or dispatch traversals the Bound sphere is also checked against the view frustum so that PagedLOD's also enable view frustum culling for subgraphs so there is no need for a separate CullNode/CullGroup to decorate it. */
     class VSG_DECLSPEC PagedLOD : public Inherit<Node, PagedLOD>
     {
@@ -42,19 +46,16 @@ namespace vsg
         struct Child
         {
             double minimumScreenHeightRatio = 0.0; // 0.0 is always visible
+            Path filename;                         // external file to load when node is null, empty for resident children
             ref_ptr<Node> node;
+            double geometricError = 0.0; // optional geometric error, in model coordinates, of the child's representation, 0.0 when not known
             // TODO need a record of the last time traversed
         };
 
-        // external file to load when child 0 is null.
-        Path filename;
-
         // priority value assigned by cull/dispatch traversal as a guide to how important the external child is for loading.
         mutable std::atomic<double> priority{0.0};
 
-        // TODO need status of external file load
-
-        using Children = std::array<Child, 2>;
+        using Children = std::vector<Child>;
 
         template<class N, class V>
         static void t_traverse(N& node, V& visitor)
@@ -76,12 +77,24 @@ namespace vsg
         void setBound(const dsphere& bound) { _bound = bound; }
         inline const dsphere& getBound() const { return _bound; }
 
-        void setChild(std::size_t pos, const Child& lodChild) { _children[pos] = lodChild; }
+        void setChild(std::size_t pos, const Child& lodChild)
+        {
+            if (pos >= _children.size()) _children.resize(pos + 1);
+            _children[pos] = lodChild;
+        }
         Child& getChild(std::size_t pos) { return _children[pos]; }
         const Child& getChild(std::size_t pos) const { return _children[pos]; }
 
         std::size_t getNumChildren() const { return _children.size(); }
 
+        /// set the filename of the external high resolution child 0, provided for compatibility with the original two child PagedLOD.
+        void setFilename(const Path& filename)
+        {
+            if (_children.empty()) _children.resize(1);
+            _children[0].filename = filename;
+        }
+        const Path& getFilename() const { return _children[0].filename; }
+
         Children& getChildren() { return _children; }
         const Children& getChildren() const { return _children; }
 
@@ -99,6 +112,24 @@ namespace vsg
         mutable std::atomic_uint64_t frameHighResLastUsed{0};
         mutable std::atomic_uint requestCount{0};
 
+        // frame that the RecordTraversal last reported the high res subgraph as in use to the DatabasePager, see CulledPagedLODs::activeRefreshInterval.
+        mutable std::atomic_uint64_t frameActiveRefreshed{0};
+
+        // index of the external child that the current request is loading.
+        mutable std::atomic_uint32_t requestChild{0};
+
+        // clock ticks of the first request, 0 until the DatabasePager has queued the request, used for the request priority and the DatabasePagerStatistics latency measurements.
+        // Atomic as it's written by DatabasePager::request() whilst other RecordTraversal may be reading it.
+        std::atomic<int64_t> requestTime{0};
+
+        // measured memory footprint of the merged external children, the CPU side from the Data they reference and the GPU side from the device memory reserved when they were compiled.
+        uint64_t cpuMemoryUsage = 0;
+        uint64_t gpuMemoryUsage = 0;
+
+        // measured memory footprint of the pending subgraph, the CPU side is assigned along with pending under DatabasePager::pendingPagedLODMutex.
+        uint64_t pendingCPUMemoryUsage = 0;
+        uint64_t pendingGPUMemoryUsage = 0;
+
         enum RequestStatus : unsigned int
         {
             NoRequest = 0,
@@ -115,7 +146,12 @@ namespace vsg
         mutable std::atomic<RequestStatus> requestStatus{NoRequest};
         mutable uint32_t index = 0;
 
+        // position in the DatabaseQueue heap, only valid while the PagedLOD is held by a DatabaseQueue.
+        mutable std::atomic_uint32_t queueIndex{0};
+
+        // loaded subgraph waiting to be compiled and merged as child pendingChild, access guarded by DatabasePager::pendingPagedLODMutex.
         ref_ptr<Node> pending;
+        uint32_t pendingChild = 0;
         ref_ptr<Semaphore> semaphore;
     };
     VSG_type_name(vsg::PagedLOD);
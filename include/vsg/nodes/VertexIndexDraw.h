@@ -32,6 +32,9 @@ namespace vsg
         void write(Output& output) const override;
 
         void compile(Context& context) override;
+
+        /// release the Vulkan buffers created by compile(), a subsequent compile() will recreate them.
+        void release();
         void dispatch(CommandBuffer& commandBuffer) const override;
 
         // vkCmdDrawIndexed settings
@@ -16,6 +16,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <set>
 #include <thread>
+#include <vector>
 
 namespace vsg
 {
@@ -31,6 +32,9 @@ namespace vsg
         operator bool () const { return !cpus.empty(); }
     };
 
+    /// list of Affinity, one per thread.
+    using Affinities = std::vector<Affinity>;
+
 
     /// Set the CPU affinity of specifiied std::thread
     extern VSG_DECLSPEC void setAffinity(std::thread& thread, const Affinity& affinity);
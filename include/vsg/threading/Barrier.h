@@ -0,0 +1,66 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Inherit.h>
+#include <vsg/threading/Futex.h>
+
+namespace vsg
+{
+
+    /// Barrier blocks the threads calling arrive_and_wait() till the specified number of threads have arrived, then releases them all and resets,
+    /// so the same Barrier can be used for every frame of a fork/join without calling set() in between. Waiting threads spin briefly before blocking, see Futex.
+    class Barrier : public Inherit<Object, Barrier>
+    {
+    public:
+        explicit Barrier(int num) :
+            _num(num),
+            _count(num) {}
+
+        /// set the number of threads that must arrive, only valid when no threads are waiting on the Barrier.
+        void set(int num)
+        {
+            _num = num;
+            _count = num;
+        }
+
+        /// block till num threads have arrived, the last thread to arrive resets the Barrier and releases the others.
+        void arrive_and_wait()
+        {
+            int generation = _generation.load();
+            if (_count.fetch_sub(1) <= 1)
+            {
+                // reset the count before releasing so that released threads can arrive for the next frame straight away
+                _count = _num;
+                ++_generation;
+                _futex.wake_all(_generation);
+            }
+            else
+            {
+                _futex.wait(_generation, [this, generation]() { return _generation.load() != generation; });
+            }
+        }
+
+        int size() const { return _num; }
+
+    protected:
+        virtual ~Barrier() {}
+
+        int _num;
+        std::atomic_int _count;
+        std::atomic_int _generation{0};
+        Futex _futex;
+    };
+    VSG_type_name(vsg::Barrier)
+
+} // namespace vsg
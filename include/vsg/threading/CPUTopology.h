@@ -0,0 +1,66 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Inherit.h>
+#include <vsg/threading/Affinity.h>
+
+#include <vector>
+
+namespace vsg
+{
+
+    /// CPUTopology describes how the logical CPUs map onto physical cores, packages (sockets) and NUMA nodes, and provides helpers for building Affinity from it.
+    /// Under Linux the topology is read from /sys/devices/system, on other platforms, or if /sys isn't available, each logical CPU is treated as a separate physical core on node 0.
+    class VSG_DECLSPEC CPUTopology : public Inherit<Object, CPUTopology>
+    {
+    public:
+        /// read the topology of the CPUs available to this process.
+        CPUTopology();
+
+        struct LogicalCPU
+        {
+            uint32_t cpu = 0;     // logical CPU number, as used by Affinity
+            uint32_t core = 0;    // physical core index, unique across packages
+            uint32_t package = 0; // physical package/socket id
+            uint32_t node = 0;    // NUMA node id
+        };
+
+        using LogicalCPUs = std::vector<LogicalCPU>;
+        LogicalCPUs logicalCPUs; // sorted by logical CPU number
+
+        uint32_t numPhysicalCores() const;
+        uint32_t numNodes() const;
+
+        /// all the logical CPUs, or just those on the specified NUMA node if node is non negative.
+        Affinity all(int node = -1) const;
+
+        /// the first logical CPU of each physical core, or just the cores on the specified NUMA node if node is non negative.
+        Affinity physicalCores(int node = -1) const;
+
+        /// the logical CPUs that share a physical core with cpu, including cpu itself.
+        Affinity siblings(uint32_t cpu) const;
+
+        /// one Affinity per physical core containing all of the core's SMT siblings, or just the cores on the specified NUMA node if node is non negative.
+        /// Used to give a thread pool one thread per physical core, e.g. OperationThreads::create(topology->perPhysicalCore(0)) for one thread per physical core on node 0.
+        Affinities perPhysicalCore(int node = -1) const;
+
+    protected:
+        virtual ~CPUTopology();
+    };
+    VSG_type_name(vsg::CPUTopology);
+
+    /// split affinity into one single CPU Affinity per CPU, used to give a thread pool one thread pinned to each CPU.
+    extern VSG_DECLSPEC Affinities perCPU(const Affinity& affinity);
+
+} // namespace vsg
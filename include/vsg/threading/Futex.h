@@ -0,0 +1,97 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Export.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#    include <immintrin.h>
+#endif
+
+namespace vsg
+{
+
+    /// hint to the CPU that the calling thread is in a spin loop, reducing power use and the penalty of leaving the loop.
+    inline void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    /// Futex provides the spin-then-block waiting used by Latch and Barrier. Waiting threads first spin for a short, adaptive, number of iterations,
+    /// and only block if the condition isn't met by then. Under Linux blocking uses the futex syscall on the address of the atomic being waited on,
+    /// other platforms fall back to a mutex/condition variable. wake_all() only makes a syscall/takes the mutex when there are threads blocked.
+    class VSG_DECLSPEC Futex
+    {
+    public:
+        Futex() {}
+
+        Futex(const Futex&) = delete;
+        Futex& operator=(const Futex&) = delete;
+
+        /// wait till ready() returns true, ready() must only depend on value, and whoever changes value to make ready() true must call wake_all(value).
+        template<typename Ready>
+        void wait(std::atomic_int& value, Ready ready)
+        {
+            // adapt the spin limit, growing it when spinning succeeds and shrinking it when the thread has to block anyway
+            uint32_t spinLimit = _spinLimit.load(std::memory_order_relaxed);
+            for (uint32_t i = 0; i < spinLimit; ++i)
+            {
+                if (ready())
+                {
+                    if (spinLimit < maxSpinLimit) _spinLimit.store(spinLimit * 2, std::memory_order_relaxed);
+                    return;
+                }
+                cpu_relax();
+            }
+            if (spinLimit > minSpinLimit) _spinLimit.store(spinLimit / 2, std::memory_order_relaxed);
+
+            for (;;)
+            {
+                int expected = value.load();
+                if (ready()) return;
+                _block(value, expected);
+            }
+        }
+
+        /// wake all the threads blocked waiting on value.
+        void wake_all(std::atomic_int& value);
+
+        static constexpr uint32_t minSpinLimit = 16;
+        static constexpr uint32_t maxSpinLimit = 4096;
+
+    protected:
+        /// block while value == expected, may return spuriously.
+        void _block(std::atomic_int& value, int expected);
+
+        std::atomic_uint32_t _spinLimit{256};
+        std::atomic_uint32_t _numWaiting{0};
+
+#if !defined(__linux__)
+        std::mutex _mutex;
+        std::condition_variable _cv;
+#endif
+    };
+
+} // namespace vsg
@@ -13,13 +13,13 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/core/Inherit.h>
-
-#include <condition_variable>
-#include <mutex>
+#include <vsg/threading/Futex.h>
 
 namespace vsg
 {
 
+    /// Latch blocks threads calling wait() till its count reaches zero. Waiting threads spin briefly before blocking, see Futex,
+    /// and count_down()/release() only wake the OS when there are threads blocked, so short waits such as per frame joins have low wake up latency.
     class Latch : public Inherit<Object, Latch>
     {
     public:
@@ -64,17 +64,12 @@ namespace vsg
 
         void wait()
         {
-            std::unique_lock lock(_mutex);
-            while (_count > 0)
-            {
-                _cv.wait(lock);
-            }
+            _futex.wait(_count, [this]() { return _count.load() <= 0; });
         }
 
         virtual void release()
         {
-            std::unique_lock lock(_mutex);
-            _cv.notify_all();
+            _futex.wake_all(_count);
         }
 
         int count() const { return _count.load(); }
@@ -83,8 +78,7 @@ namespace vsg
         virtual ~Latch() {}
 
         std::atomic_int _count;
-        std::mutex _mutex;
-        std::condition_variable _cv;
+        Futex _futex;
     };
     VSG_type_name(vsg::Latch)
 
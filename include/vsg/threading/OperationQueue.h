@@ -13,8 +13,11 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/threading/Latch.h>
+#include <vsg/threading/RingBuffer.h>
 
-#include <list>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace vsg
 {
@@ -37,47 +40,48 @@ namespace vsg
         virtual void run() = 0;
     };
 
+    /// OperationQueue is a thread safe FIFO queue of Operation, backed by a lock free RingBuffer so that adding operations doesn't contend with the threads taking them.
+    /// When the RingBuffer is full operations are added to an unbounded overflow, so add() never blocks.
     class VSG_DECLSPEC OperationQueue : public Inherit<Object, OperationQueue>
     {
     public:
-        OperationQueue(ref_ptr<Active> in_active);
+        OperationQueue(ref_ptr<Active> in_active, size_t capacity = 4096);
 
         Active* getActive() { return _active; }
         const Active* getActive() const { return _active; }
 
         void add(ref_ptr<Operation> operation)
         {
-            std::scoped_lock lock(_mutex);
-            _queue.emplace_back(operation);
-            _cv.notify_one();
+            // once the ring buffer has overflowed, operations go to the overflow till it's been emptied so that they are still taken in the order they were added
+            if (_numOverflow.load() == 0 && _queue.push(operation)) return;
+            _addToOverflow(operation);
         }
 
         template<typename Iterator>
         void add(Iterator begin, Iterator end)
         {
-            size_t numAdditions = 0;
-            std::scoped_lock lock(_mutex);
             for (auto itr = begin; itr != end; ++itr)
             {
-                _queue.emplace_back(*itr);
-                ++numAdditions;
+                add(*itr);
             }
-
-            if (numAdditions == 1)
-                _cv.notify_one();
-            else if (numAdditions > 1)
-                _cv.notify_all();
         }
 
         ref_ptr<Operation> take();
 
         ref_ptr<Operation> take_when_avilable();
 
+        /// wake all threads blocked in take_when_avilable(), call after the Active flag has been cleared so they exit promptly.
+        void release() { _queue.release(); }
+
     protected:
-        std::mutex _mutex;
-        std::condition_variable _cv;
-        std::list<ref_ptr<Operation>> _queue;
+        void _addToOverflow(ref_ptr<Operation> operation);
+
+        RingBuffer<ref_ptr<Operation>> _queue;
         ref_ptr<Active> _active;
+
+        std::mutex _overflowMutex;
+        std::deque<ref_ptr<Operation>> _overflow;
+        std::atomic_size_t _numOverflow{0};
     };
     VSG_type_name(vsg::OperationQueue)
 
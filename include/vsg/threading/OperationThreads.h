@@ -12,8 +12,11 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/threading/Affinity.h>
 #include <vsg/threading/OperationQueue.h>
+#include <vsg/threading/ThreadPriority.h>
 
+#include <list>
 #include <thread>
 
 namespace vsg
@@ -22,7 +25,10 @@ namespace vsg
     class VSG_DECLSPEC OperationThreads : public Inherit<Object, OperationThreads>
     {
     public:
-        OperationThreads(uint32_t numThreads, ref_ptr<Active> in_active = {});
+        OperationThreads(uint32_t numThreads, ref_ptr<Active> in_active = {}, ThreadPriority priority = ThreadPriority::Default);
+
+        /// create one thread per Affinity, each thread sets its own CPU affinity and priority when it starts, an empty Affinity leaves that thread free to run on any CPU.
+        explicit OperationThreads(const Affinities& affinities, ref_ptr<Active> in_active = {}, ThreadPriority priority = ThreadPriority::Default);
 
         void add(ref_ptr<Operation> operation)
         {
@@ -0,0 +1,588 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/Affinity.h>
+#include <vsg/threading/OperationQueue.h>
+#include <vsg/threading/RingBuffer.h>
+#include <vsg/threading/ThreadPriority.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vsg
+{
+
+    /// order in which a StageQueue hands out its items.
+    enum class QueuePolicy
+    {
+        FIFO,    // first added, first taken
+        Priority // highest PipelineTraits<T>::priority() first
+    };
+
+    /// PipelineTraits tells StageQueue how to read the priority of an item and where to record the item's position in the queue, so that updatePriorities()
+    /// can reposition it in O(log n). The default uses the item's mutable std::atomic priority and queueIndex members, as provided by PipelineItem and PagedLOD,
+    /// specialize PipelineTraits for item types that store them elsewhere.
+    template<typename T>
+    struct PipelineTraits
+    {
+        static double priority(const T& item) { return item.priority.load(); }
+        static void setQueueIndex(const T& item, uint32_t index) { item.queueIndex = index; }
+        static uint32_t getQueueIndex(const T& item) { return item.queueIndex.load(); }
+    };
+
+    /// PipelineItem is a convenience base class for application items passed through a Pipeline.
+    class PipelineItem : public Inherit<Object, PipelineItem>
+    {
+    public:
+        PipelineItem() {}
+
+        // priority of the item when taken from a QueuePolicy::Priority StageQueue, increase then call StageQueue::updatePriorities() to reposition queued items.
+        mutable std::atomic<double> priority{0.0};
+
+        // position in the StageQueue's heap, maintained by the StageQueue.
+        mutable std::atomic_uint32_t queueIndex{0};
+
+        // set to cancel the item, items are discarded by a PipelineStage whose cancelled predicate returns true.
+        std::atomic_bool cancelled{false};
+
+    protected:
+        virtual ~PipelineItem() {}
+    };
+    VSG_type_name(vsg::PipelineItem);
+
+    /// StageQueue is the thread safe input queue of a PipelineStage.
+    /// Items are added to a lock free RingBuffer that the consuming threads drain into a binary max heap, so add() doesn't contend on the queue's mutex and
+    /// take is O(log n). With QueuePolicy::FIFO the heap is ordered by the order the items were drained in.
+    template<typename T>
+    class StageQueue : public Inherit<Object, StageQueue<T>>
+    {
+    public:
+        using Items = std::vector<ref_ptr<T>>;
+        using Traits = PipelineTraits<T>;
+
+        StageQueue(ref_ptr<Active> in_active, QueuePolicy in_policy = QueuePolicy::Priority, size_t capacity = 4096) :
+            _incoming(capacity),
+            _active(in_active),
+            _policy(in_policy)
+        {
+        }
+
+        Active* getActive() { return _active; }
+        const Active* getActive() const { return _active; }
+
+        QueuePolicy getPolicy() const { return _policy; }
+
+        void add(ref_ptr<T> item) { _add(item); }
+
+        // add the item reference to the queue then set the item parameter to nullptr to ensure calling thread can't delete it
+        void add_then_reset(ref_ptr<T>& item) { _add(item); }
+
+        void add(Items& items)
+        {
+            for (auto& item : items)
+            {
+                ref_ptr<T> local = item;
+                _add(local);
+            }
+        }
+
+        /// take the first item, blocking while the queue is empty, returns null if the queue's Active flag is cleared.
+        ref_ptr<T> take_when_available()
+        {
+            std::unique_lock lock(_mutex);
+            if (!_wait(lock)) return {};
+
+            auto item = _pop();
+
+            // another consumer may have been woken for an entry that this thread drained into the heap, so pass the wake up on
+            if (!_heap.empty() && _numWaiting > 0) _cv.notify_one();
+
+            return item;
+        }
+
+        /// take up to maxNumItems, blocking while the queue is empty, returns an empty list if the queue's Active flag is cleared.
+        /// Items are only returned in queue order when fewer than all the items in the queue are taken.
+        Items take_all_when_available(size_t maxNumItems = std::numeric_limits<size_t>::max())
+        {
+            std::unique_lock lock(_mutex);
+            if (!_wait(lock)) return {};
+
+            auto items = (maxNumItems >= _heap.size()) ? _takeAll() : _take(maxNumItems);
+            if (!_heap.empty() && _numWaiting > 0) _cv.notify_one();
+            return items;
+        }
+
+        Items take_all()
+        {
+            std::scoped_lock lock(_mutex);
+            _drain();
+            return _takeAll();
+        }
+
+        /// remove and return up to maxNumItems from the queue, in queue order.
+        Items take(size_t maxNumItems)
+        {
+            std::scoped_lock lock(_mutex);
+            _drain();
+            return _take(maxNumItems);
+        }
+
+        /// remove and return all the items in the queue for which predicate(const T*) returns true.
+        template<class Predicate>
+        Items take_if(Predicate predicate)
+        {
+            std::scoped_lock lock(_mutex);
+            _drain();
+
+            Items items;
+            size_t numRetained = 0;
+            for (auto& entry : _heap)
+            {
+                if (predicate(static_cast<const T*>(entry.item.get())))
+                    items.emplace_back(std::move(entry.item));
+                else
+                    _heap[numRetained++] = std::move(entry);
+            }
+
+            if (!items.empty())
+            {
+                _heap.resize(numRetained);
+                _rebuildHeap();
+            }
+            return items;
+        }
+
+        /// reposition the items in a QueuePolicy::Priority queue to reflect any increase in their priority since they were added, items not in the queue are ignored.
+        void updatePriorities(const std::vector<const T*>& items)
+        {
+            if (items.empty() || _policy != QueuePolicy::Priority) return;
+
+            std::scoped_lock lock(_mutex);
+            _drain();
+
+            for (auto& item : items)
+            {
+                // the queue index is only meaningful if this queue's heap entry at that position refers back to the item.
+                size_t index = Traits::getQueueIndex(*item);
+                if (index >= _heap.size() || _heap[index].item.get() != item) continue;
+
+                double priority = Traits::priority(*item);
+                if (priority > _heap[index].priority)
+                {
+                    _heap[index].priority = priority;
+                    _siftUp(index);
+                }
+            }
+        }
+
+        size_t size() const
+        {
+            std::scoped_lock lock(_mutex);
+            return _heap.size() + _incoming.size();
+        }
+
+        /// wake all threads blocked in take_when_available()/take_all_when_available(), call after the Active flag has been cleared so they exit promptly.
+        void release()
+        {
+            std::scoped_lock lock(_mutex);
+            _cv.notify_all();
+        }
+
+    protected:
+        virtual ~StageQueue() {}
+
+        // heap entries cache the priority at the time of insertion/update so that the heap ordering remains
+        // stable while other threads concurrently increase the items' priority.
+        struct Entry
+        {
+            double priority = 0.0;
+            ref_ptr<T> item;
+        };
+
+        using Heap = std::vector<Entry>;
+
+        // push item onto the _incoming ring buffer and wake a waiting consumer, doesn't require _mutex to be locked.
+        void _add(ref_ptr<T>& item)
+        {
+            while (!_incoming.push(item))
+            {
+                // the ring buffer is full, so make room by moving its contents into the heap
+                std::scoped_lock lock(_mutex);
+                _drain();
+            }
+
+            // pairs with the fence in _wait() so either this thread sees the waiting count or the consumer sees the new entry
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (_numWaiting.load(std::memory_order_relaxed) > 0)
+            {
+                std::scoped_lock lock(_mutex);
+                _cv.notify_one();
+            }
+        }
+
+        // the following methods require _mutex to be locked by the caller
+
+        // wait till the heap has entries, returns false if the Active flag has been cleared.
+        bool _wait(std::unique_lock<std::mutex>& lock)
+        {
+            std::chrono::duration waitDuration = std::chrono::milliseconds(100);
+
+            _drain();
+            while (_heap.empty() && *_active)
+            {
+                ++_numWaiting;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (_incoming.empty()) _cv.wait_for(lock, waitDuration);
+                --_numWaiting;
+
+                _drain();
+            }
+
+            return !_heap.empty() && *_active;
+        }
+
+        void _drain()
+        {
+            ref_ptr<T> item;
+            while (_incoming.take(item))
+            {
+                _push(item);
+            }
+        }
+
+        void _push(const ref_ptr<T>& item)
+        {
+            // FIFO queues order by a decreasing sequence number so that the earliest drained item is at the top of the heap
+            double priority = (_policy == QueuePolicy::Priority) ? Traits::priority(*item) : -static_cast<double>(_sequence++);
+            _heap.emplace_back(Entry{priority, item});
+
+            size_t index = _heap.size() - 1;
+            Traits::setQueueIndex(*item, static_cast<uint32_t>(index));
+            _siftUp(index);
+        }
+
+        ref_ptr<T> _pop()
+        {
+            ref_ptr<T> item = _heap.front().item;
+
+            Entry last = std::move(_heap.back());
+            _heap.pop_back();
+
+            if (!_heap.empty())
+            {
+                _assign(0, std::move(last));
+                _siftDown(0);
+            }
+
+            return item;
+        }
+
+        Items _take(size_t maxNumItems)
+        {
+            Items items;
+            items.reserve(std::min(maxNumItems, _heap.size()));
+            while (!_heap.empty() && items.size() < maxNumItems)
+            {
+                items.emplace_back(_pop());
+            }
+            return items;
+        }
+
+        // take all the items without maintaining the heap ordering, so the items aren't returned in queue order.
+        Items _takeAll()
+        {
+            Items items;
+            items.reserve(_heap.size());
+            for (auto& entry : _heap)
+            {
+                items.emplace_back(std::move(entry.item));
+            }
+            _heap.clear();
+            return items;
+        }
+
+        void _assign(size_t index, Entry&& entry)
+        {
+            Traits::setQueueIndex(*entry.item, static_cast<uint32_t>(index));
+            _heap[index] = std::move(entry);
+        }
+
+        void _siftUp(size_t index)
+        {
+            Entry entry = std::move(_heap[index]);
+            while (index > 0)
+            {
+                size_t parent = (index - 1) / 2;
+                if (!(_heap[parent].priority < entry.priority)) break;
+
+                _assign(index, std::move(_heap[parent]));
+                index = parent;
+            }
+            _assign(index, std::move(entry));
+        }
+
+        void _siftDown(size_t index)
+        {
+            size_t size = _heap.size();
+            Entry entry = std::move(_heap[index]);
+            for (;;)
+            {
+                size_t child = 2 * index + 1;
+                if (child >= size) break;
+
+                // select the child with the highest priority
+                if ((child + 1) < size && _heap[child].priority < _heap[child + 1].priority) ++child;
+                if (!(entry.priority < _heap[child].priority)) break;
+
+                _assign(index, std::move(_heap[child]));
+                index = child;
+            }
+            _assign(index, std::move(entry));
+        }
+
+        void _rebuildHeap()
+        {
+            for (size_t index = 0; index < _heap.size(); ++index)
+            {
+                Traits::setQueueIndex(*_heap[index].item, static_cast<uint32_t>(index));
+            }
+
+            for (size_t index = _heap.size() / 2; index > 0; --index)
+            {
+                _siftDown(index - 1);
+            }
+        }
+
+        mutable std::mutex _mutex;
+        std::condition_variable _cv;
+        std::atomic_uint32_t _numWaiting{0};
+        RingBuffer<ref_ptr<T>> _incoming;
+        Heap _heap;
+        uint64_t _sequence = 0;
+        ref_ptr<Active> _active;
+        QueuePolicy _policy;
+    };
+
+    /// PipelineStage runs a pool of threads that take items from its input StageQueue and pass them to the process function,
+    /// which continues the item on to the next stage by adding it to the output queue, or discards it.
+    /// The concurrency limit controls how many of the stage's threads take items at once, threads are started as the limit is raised and parked when it's lowered.
+    template<typename T>
+    class PipelineStage : public Inherit<Object, PipelineStage<T>>
+    {
+    public:
+        using Queue = StageQueue<T>;
+        using Items = typename Queue::Items;
+
+        /// process the items taken from the input queue, threadIndex is the index of the calling thread within the stage.
+        using Function = std::function<void(PipelineStage& stage, Items& items, uint32_t threadIndex)>;
+
+        PipelineStage(ref_ptr<Queue> in_input, Function in_process) :
+            input(in_input),
+            process(in_process)
+        {
+        }
+
+        ref_ptr<Queue> input;
+
+        /// queue that the process function continues items on to, typically the input of the next stage, or a queue drained by the application.
+        ref_ptr<Queue> output;
+
+        Function process;
+
+        /// optional predicate that discards items when they are taken from the input, rather than passing them to process.
+        std::function<bool(const T&)> cancelled;
+
+        /// optional function called with each item discarded by the cancelled predicate.
+        std::function<void(ref_ptr<T>& item)> discarded;
+
+        /// maximum number of items passed to each process call, 1 for items to be processed one at a time, 0 for all the items available.
+        uint32_t maxBatchSize = 1;
+
+        /// CPU affinity and priority class of the stage's threads, applied as each thread starts.
+        Affinity affinity;
+        ThreadPriority threadPriority = ThreadPriority::Default;
+
+        /// set the number of threads that take items from the input queue concurrently, starting new threads as required.
+        void setConcurrencyLimit(uint32_t limit)
+        {
+            {
+                // set with the mutex held so that a thread about to park can't miss the change
+                std::scoped_lock lock(_parkedMutex);
+                _concurrencyLimit = limit;
+            }
+            _parkedCV.notify_all();
+
+            std::scoped_lock lock(_threadsMutex);
+            while (_threads.size() < limit)
+            {
+                uint32_t threadIndex = static_cast<uint32_t>(_threads.size());
+                _threads.emplace_back([this, threadIndex]() { _run(threadIndex); });
+            }
+        }
+
+        uint32_t getConcurrencyLimit() const { return _concurrencyLimit.load(); }
+
+        /// number of threads started, including threads parked by a lowered concurrency limit.
+        uint32_t getNumThreads() const
+        {
+            std::scoped_lock lock(_threadsMutex);
+            return static_cast<uint32_t>(_threads.size());
+        }
+
+        /// stop and join the stage's threads. Clears the input queue's Active flag, so also stops any other stages sharing it.
+        void stop()
+        {
+            input->getActive()->active.exchange(false);
+            input->release();
+
+            {
+                std::scoped_lock lock(_parkedMutex);
+                _parkedCV.notify_all();
+            }
+
+            std::scoped_lock lock(_threadsMutex);
+            for (auto& thread : _threads)
+            {
+                if (thread.joinable()) thread.join();
+            }
+            _threads.clear();
+        }
+
+    protected:
+        virtual ~PipelineStage()
+        {
+            stop();
+        }
+
+        void _run(uint32_t threadIndex)
+        {
+            if (affinity) setAffinity(affinity);
+            setThreadPriority(threadPriority);
+
+            const auto& active = *(input->getActive());
+            while (active)
+            {
+                // threads beyond the current concurrency limit are parked until the limit is raised again
+                if (threadIndex >= _concurrencyLimit.load())
+                {
+                    std::unique_lock lock(_parkedMutex);
+                    // the timeout is only a safety net, setConcurrencyLimit() and stop() wake parked threads directly
+                    if (threadIndex >= _concurrencyLimit.load() && active) _parkedCV.wait_for(lock, std::chrono::milliseconds(100));
+                    continue;
+                }
+
+                Items items;
+                if (maxBatchSize == 1)
+                {
+                    if (auto item = input->take_when_available()) items.emplace_back(item);
+                }
+                else
+                {
+                    items = input->take_all_when_available((maxBatchSize == 0) ? std::numeric_limits<size_t>::max() : maxBatchSize);
+                }
+
+                if (cancelled)
+                {
+                    size_t numRetained = 0;
+                    for (auto& item : items)
+                    {
+                        if (cancelled(*item))
+                        {
+                            if (discarded) discarded(item);
+                        }
+                        else
+                        {
+                            items[numRetained++] = item;
+                        }
+                    }
+                    items.resize(numRetained);
+                }
+
+                if (!items.empty()) process(*this, items, threadIndex);
+            }
+        }
+
+        std::atomic_uint32_t _concurrencyLimit{0};
+
+        std::mutex _parkedMutex;
+        std::condition_variable _parkedCV;
+
+        mutable std::mutex _threadsMutex;
+        std::list<std::thread> _threads;
+    };
+
+    /// Pipeline chains a series of PipelineStage that share an Active flag, each stage's output is the input of the next stage,
+    /// and the last stage's output is drained by the application, such as once per frame to merge loaded and compiled assets into the scene graph.
+    template<typename T>
+    class Pipeline : public Inherit<Object, Pipeline<T>>
+    {
+    public:
+        using Stage = PipelineStage<T>;
+        using Queue = StageQueue<T>;
+        using Items = typename Queue::Items;
+
+        explicit Pipeline(ref_ptr<Active> in_active = {}, QueuePolicy outputPolicy = QueuePolicy::FIFO) :
+            active(in_active)
+        {
+            if (!active) active = Active::create();
+            output = Queue::create(active, outputPolicy);
+        }
+
+        /// append a stage to the pipeline, its input is the output of the previous stage. The stage's threads are started by setConcurrencyLimit().
+        ref_ptr<Stage> addStage(typename Stage::Function process, QueuePolicy policy = QueuePolicy::FIFO)
+        {
+            // the new stage's input replaces the pipeline's output as the output of the previous stage
+            auto input = Queue::create(active, policy);
+            if (!stages.empty()) stages.back()->output = input;
+
+            auto stage = Stage::create(input, process);
+            stage->output = output;
+            stages.push_back(stage);
+            return stage;
+        }
+
+        /// add an item to the input of the first stage.
+        void add(ref_ptr<T> item)
+        {
+            if (!stages.empty()) stages.front()->input->add(item);
+        }
+
+        /// stop all the stages' threads.
+        void stop()
+        {
+            active->active.exchange(false);
+            for (auto& stage : stages) stage->input->release();
+            for (auto& stage : stages) stage->stop();
+        }
+
+        ref_ptr<Active> active;
+        std::vector<ref_ptr<Stage>> stages;
+
+        /// queue of items that have passed through the last stage.
+        ref_ptr<Queue> output;
+
+    protected:
+        virtual ~Pipeline()
+        {
+            stop();
+        }
+    };
+
+} // namespace vsg
@@ -0,0 +1,193 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace vsg
+{
+
+    /// RingBuffer is a bounded, lock free, multiple producer/multiple consumer FIFO queue.
+    /// Each slot carries a sequence number that producers and consumers use to claim it, so push() and take() only contend on a single atomic
+    /// compare-and-swap. Consumers that want to block while the buffer is empty use take_when_available(), producers only touch the
+    /// mutex/condition variable used to wake them when there are consumers waiting.
+    template<typename T>
+    class RingBuffer
+    {
+    public:
+        /// capacity is rounded up to the next power of two.
+        explicit RingBuffer(size_t minimumCapacity = 1024)
+        {
+            size_t capacity = 2;
+            while (capacity < minimumCapacity) capacity <<= 1;
+
+            _cells.reset(new Cell[capacity]);
+            _mask = capacity - 1;
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        size_t capacity() const { return _mask + 1; }
+
+        /// approximate number of entries, only exact when no other threads are pushing or taking.
+        size_t size() const
+        {
+            // load the dequeue position first so that the enqueue position can't be behind it.
+            size_t dequeuePos = _dequeuePos.load(std::memory_order_seq_cst);
+            size_t enqueuePos = _enqueuePos.load(std::memory_order_seq_cst);
+            return enqueuePos - dequeuePos;
+        }
+
+        bool empty() const { return size() == 0; }
+
+        /// add value to the end of the buffer, returns false without modifying value if the buffer is full.
+        /// On success value is reset so that the buffer holds the only reference the calling thread passed in.
+        bool push(T& value)
+        {
+            Cell* cell = nullptr;
+            size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                cell = &_cells[pos & _mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (difference == 0)
+                {
+                    if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (difference < 0)
+                {
+                    // slot still occupied from the previous lap, buffer is full
+                    return false;
+                }
+                else
+                {
+                    pos = _enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->value = std::move(value);
+            value = T{};
+            cell->sequence.store(pos + 1, std::memory_order_release);
+
+            notify();
+            return true;
+        }
+
+        /// remove the head of the buffer and assign it to value, returns false if the buffer is empty.
+        bool take(T& value)
+        {
+            Cell* cell = nullptr;
+            size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                cell = &_cells[pos & _mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+                if (difference == 0)
+                {
+                    if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (difference < 0)
+                {
+                    // slot not yet written, buffer is empty
+                    return false;
+                }
+                else
+                {
+                    pos = _dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            value = std::move(cell->value);
+            cell->value = T{};
+            cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// take the head of the buffer, blocking while the buffer is empty and active is true. Returns false if active is cleared before an entry becomes available.
+        bool take_when_available(T& value, const std::atomic_bool& active)
+        {
+            while (active)
+            {
+                if (take(value)) return true;
+
+                wait(active, []() { return true; });
+            }
+            return false;
+        }
+
+        /// block while the buffer is empty, active is true and condition() returns true, condition() is checked with the mutex held.
+        /// Woken by push(), notify() and release(), so producers that add entries somewhere other than the buffer must call notify() after adding them.
+        template<typename Condition>
+        void wait(const std::atomic_bool& active, Condition condition)
+        {
+            ++_numWaiting;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            {
+                std::unique_lock lock(_mutex);
+                // the timeout is only a safety net, push(), notify() and release() wake waiting threads directly
+                if (empty() && condition() && active) _cv.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            --_numWaiting;
+        }
+
+        /// wake one thread blocked in take_when_available(), only locks the mutex if there are threads waiting.
+        void notify()
+        {
+            // pairs with the fence in take_when_available() so either the producer sees the waiting count or the consumer sees the new entry
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (_numWaiting.load(std::memory_order_relaxed) > 0)
+            {
+                std::scoped_lock lock(_mutex);
+                _cv.notify_one();
+            }
+        }
+
+        /// wake all threads blocked in take_when_available(), used on shutdown after the associated active flag has been cleared.
+        void release()
+        {
+            std::scoped_lock lock(_mutex);
+            _cv.notify_all();
+        }
+
+    protected:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> _cells;
+        size_t _mask = 0;
+
+        // keep the producer and consumer positions on separate cache lines to avoid false sharing
+        alignas(64) std::atomic<size_t> _enqueuePos{0};
+        alignas(64) std::atomic<size_t> _dequeuePos{0};
+        alignas(64) std::atomic_uint32_t _numWaiting{0};
+
+        std::mutex _mutex;
+        std::condition_variable _cv;
+    };
+
+} // namespace vsg
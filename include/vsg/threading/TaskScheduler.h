@@ -0,0 +1,208 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/Affinity.h>
+#include <vsg/threading/Latch.h>
+#include <vsg/threading/OperationQueue.h>
+#include <vsg/threading/RingBuffer.h>
+#include <vsg/threading/ThreadPriority.h>
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <thread>
+#include <vector>
+
+namespace vsg
+{
+
+    /// FunctionOperation adapts a callable object to the Operation interface so it can be run by a TaskScheduler or OperationThreads.
+    template<typename F>
+    class FunctionOperation : public Operation
+    {
+    public:
+        explicit FunctionOperation(F in_function) :
+            function(in_function) {}
+
+        void run() override { function(); }
+
+        F function;
+    };
+
+    /// TaskScheduler is a work stealing thread pool. Each worker thread has its own deque of operations, operations added from a worker thread
+    /// are pushed onto that worker's deque and run most recently added first, while idle workers steal the least recently added operations from
+    /// the other workers. Operations added from threads outside the scheduler are passed to the workers via a shared lock free RingBuffer, with an
+    /// unbounded overflow used when the RingBuffer is full so that add() never blocks.
+    /// Threads waiting on the completion of operations, such as TaskGroup::wait(), run pending operations via run_one(), only blocking once there are none left to run.
+    class VSG_DECLSPEC TaskScheduler : public Inherit<Object, TaskScheduler>
+    {
+    public:
+        /// create numThreads worker threads, a value of 0 uses one thread per hardware thread less one for the calling thread.
+        /// Each worker thread sets its priority when it starts.
+        explicit TaskScheduler(uint32_t numThreads = 0, ref_ptr<Active> in_active = {}, ThreadPriority priority = ThreadPriority::Default);
+
+        /// add an operation to be run by one of the worker threads.
+        void add(ref_ptr<Operation> operation);
+
+        /// add a callable object to be run by one of the worker threads.
+        template<typename F>
+        void add_function(F function)
+        {
+            add(ref_ptr<Operation>(new FunctionOperation<F>(function)));
+        }
+
+        template<typename Iterator>
+        void add(Iterator begin, Iterator end)
+        {
+            for (auto itr = begin; itr != end; ++itr)
+            {
+                add(*itr);
+            }
+        }
+
+        /// run one pending operation on the calling thread, returns false if no operations were available.
+        bool run_one();
+
+        /// use this thread to run operations till none are pending.
+        void run();
+
+        /// set the CPU affinity of the worker threads, worker i is assigned the i'th CPU in the affinity, or all of them if affinity.cpus is smaller than the number of workers.
+        void setAffinity(const Affinity& affinity);
+
+        /// stop and join the worker threads, pending operations that haven't been started are discarded, as are operations added after stopping.
+        /// Discarded operations of a TaskGroup count down its latch so that TaskGroup::wait() returns.
+        void stop();
+
+        /// number of worker threads, 0 once stopped.
+        uint32_t getNumThreads() const { return *active ? static_cast<uint32_t>(_workers.size()) : 0; }
+
+        /// index of the calling thread if it's one of this TaskScheduler's worker threads, otherwise returns the number of workers.
+        uint32_t getWorkerIndex() const;
+
+        ref_ptr<Active> active;
+
+    protected:
+        virtual ~TaskScheduler();
+
+        struct Worker
+        {
+            TaskScheduler* scheduler = nullptr;
+            uint32_t index = 0;
+            ThreadPriority priority = ThreadPriority::Default;
+            std::mutex mutex;
+            std::deque<ref_ptr<Operation>> operations;
+            std::thread thread;
+        };
+
+        ref_ptr<Operation> _take(Worker* worker);
+        ref_ptr<Operation> _steal(uint32_t startIndex);
+        void _wait();
+        void _notify();
+
+        std::vector<std::unique_ptr<Worker>> _workers;
+        RingBuffer<ref_ptr<Operation>> _injected;
+
+        std::mutex _overflowMutex;
+        std::deque<ref_ptr<Operation>> _overflow;
+        std::atomic_size_t _numOverflow{0};
+
+        std::atomic_uint64_t _numPending{0};
+        std::atomic_uint32_t _numWaiting{0};
+        std::mutex _mutex;
+        std::condition_variable _cv;
+    };
+    VSG_type_name(vsg::TaskScheduler);
+
+    /// TaskGroup tracks a set of operations run on a TaskScheduler so that they can be waited on together.
+    /// wait() runs pending operations on the calling thread until all the group's operations have completed, so TaskGroup can be safely nested inside operations.
+    class VSG_DECLSPEC TaskGroup : public Inherit<Object, TaskGroup>
+    {
+    public:
+        explicit TaskGroup(ref_ptr<TaskScheduler> in_scheduler);
+
+        void add(ref_ptr<Operation> operation);
+
+        template<typename F>
+        void add_function(F function)
+        {
+            add(ref_ptr<Operation>(new FunctionOperation<F>(function)));
+        }
+
+        /// wait for all the operations added to the group to complete, running pending operations on the calling thread whilst waiting and blocking once there are none left.
+        void wait();
+
+        bool is_ready() const { return _latch->is_ready(); }
+
+        ref_ptr<TaskScheduler> scheduler;
+
+    protected:
+        virtual ~TaskGroup();
+
+        ref_ptr<Latch> _latch;
+    };
+    VSG_type_name(vsg::TaskGroup);
+
+    /// call function(i) for each i in the range [begin, end), splitting the range into chunks of grainSize that are run in parallel on the TaskScheduler's workers and the calling thread.
+    template<typename F>
+    void parallel_for(TaskScheduler& scheduler, size_t begin, size_t end, size_t grainSize, F function)
+    {
+        if (begin >= end) return;
+
+        grainSize = std::max(grainSize, size_t(1));
+        if ((end - begin) <= grainSize)
+        {
+            for (size_t i = begin; i < end; ++i) function(i);
+            return;
+        }
+
+        auto group = TaskGroup::create(ref_ptr<TaskScheduler>(&scheduler));
+        for (size_t chunk_begin = begin; chunk_begin < end; chunk_begin += grainSize)
+        {
+            size_t chunk_end = std::min(chunk_begin + grainSize, end);
+            group->add_function([&function, chunk_begin, chunk_end]() {
+                for (size_t i = chunk_begin; i < chunk_end; ++i) function(i);
+            });
+        }
+        group->wait();
+    }
+
+    /// reduce the range [begin, end) in parallel, function(chunk_begin, chunk_end, identity) returns the result for a chunk of up to grainSize elements,
+    /// and the chunk results are combined in order using reduce(lhs, rhs) starting from identity.
+    template<typename T, typename F, typename R>
+    T parallel_reduce(TaskScheduler& scheduler, size_t begin, size_t end, size_t grainSize, const T& identity, F function, R reduce)
+    {
+        if (begin >= end) return identity;
+
+        grainSize = std::max(grainSize, size_t(1));
+        size_t numChunks = (end - begin + grainSize - 1) / grainSize;
+        if (numChunks == 1) return reduce(identity, function(begin, end, identity));
+
+        std::vector<T> results(numChunks, identity);
+        auto group = TaskGroup::create(ref_ptr<TaskScheduler>(&scheduler));
+        for (size_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            size_t chunk_begin = begin + chunk * grainSize;
+            size_t chunk_end = std::min(chunk_begin + grainSize, end);
+            group->add_function([&function, &results, &identity, chunk, chunk_begin, chunk_end]() {
+                results[chunk] = function(chunk_begin, chunk_end, identity);
+            });
+        }
+        group->wait();
+
+        T result = identity;
+        for (auto& value : results) result = reduce(result, value);
+        return result;
+    }
+
+} // namespace vsg
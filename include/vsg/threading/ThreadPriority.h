@@ -0,0 +1,33 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Export.h>
+
+namespace vsg
+{
+
+    /// ThreadPriority classes used to keep background work such as database paging from competing with the threads recording and submitting frames.
+    enum class ThreadPriority
+    {
+        Default,    // leave the thread at the priority it inherits from the thread that created it
+        Low,        // below the default, Linux nice 5, Windows THREAD_PRIORITY_BELOW_NORMAL, macOS QOS_CLASS_UTILITY
+        Background, // throughput orientated work, Linux SCHED_BATCH with nice 10, Windows THREAD_PRIORITY_LOWEST, macOS QOS_CLASS_BACKGROUND
+        Idle        // only run when a CPU would otherwise be idle, Linux SCHED_IDLE, Windows THREAD_PRIORITY_IDLE, macOS QOS_CLASS_BACKGROUND
+    };
+
+    /// Set the priority class of the current thread, returns false if the OS rejected the request.
+    /// The priority is only applied to the calling thread, so thread pools call this as each of their threads starts.
+    extern VSG_DECLSPEC bool setThreadPriority(ThreadPriority priority);
+
+} // namespace vsg
@@ -24,11 +24,13 @@ namespace vsg
         while (t < original_value && !reference.compare_exchange_weak(original_value, t)) {}
     };
 
+    /// set the atomic to t if t is greater than the current value, return true if the value was changed.
     template<typename T>
-    void exchange_if_greater(std::atomic<T>& reference, T t)
+    bool exchange_if_greater(std::atomic<T>& reference, T t)
     {
         T original_value = reference.load();
         while (t > original_value && !reference.compare_exchange_weak(original_value, t)) {}
+        return t > original_value;
     };
 
     template<typename T>
@@ -13,6 +13,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/core/Object.h>
+#include <vsg/maths/mat4.h>
+#include <vsg/maths/sphere.h>
+
+#include <limits>
+#include <unordered_map>
+#include <vector>
 
 namespace vsg
 {
@@ -22,17 +28,45 @@ namespace vsg
     class Group;
     class QuadGroup;
     class LOD;
+    class PagedLOD;
     class StateGroup;
+    class CullGroup;
+    class CullNode;
+    class BatchCullGroup;
+    class MatrixTransform;
 
     class Command;
+    class Commands;
     class CommandBuffer;
     class RenderPass;
+    class StateCommand;
+    class State;
+    class DatabasePager;
+    class FrameStamp;
+    class CulledPagedLODs;
+    class DrawList;
+    struct DrawItem;
+    class RecordTraversal;
 
+    /// CullTraversal culls the scene graph against the view frustum, selects LOD and PagedLOD children and requests PagedLOD external children in the same way
+    /// as the RecordTraversal, but rather than dispatching the visible Commands it adds them to a DrawList along with their state and modelview matrix.
+    /// Each drawable Command, such as a Commands, Geometry, VertexIndexDraw or DrawIndexed, forms a DrawItem along with the BindVertexBuffers, BindIndexBuffer
+    /// and StateCommand that precede it, and any drawable Commands that follow it before the next bind.
+    /// DrawItem drawn with a GraphicsPipeline that enables blending are placed in the transparent bin, all others in the opaque bin.
+    /// The DrawList can then be sorted to minimize pipeline and descriptor set binds, and recorded via RecordTraversal::apply(const DrawList&).
     class VSG_DECLSPEC CullTraversal : public Object
     {
     public:
+        explicit CullTraversal(uint32_t maxSlot = 2, ref_ptr<FrameStamp> fs = {});
+        ~CullTraversal();
+
         unsigned int numNodes = 0;
 
+        void setProjectionAndViewMatrix(const dmat4& projMatrix, const dmat4& viewMatrix);
+
+        /// clear the drawList and copy the state, frustum and paging settings of the RecordTraversal that the DrawList will be recorded by.
+        void reset(const RecordTraversal& recordTraversal);
+
         void apply(const Object& object);
 
         // scene graph nodes
@@ -40,11 +74,62 @@ namespace vsg
         void apply(const Group& object);
         void apply(const QuadGroup& object);
         void apply(const LOD& object);
+        void apply(const PagedLOD& object);
+        void apply(const CullGroup& object);
+        void apply(const CullNode& object);
+        void apply(const BatchCullGroup& object);
+        void apply(const MatrixTransform& object);
         void apply(const StateGroup& object);
 
         // Vulkan nodes
+        void apply(const Commands& object);
         void apply(const Command& object);
         void apply(const CommandBuffer& object);
         void apply(const RenderPass& object);
+
+        ref_ptr<DrawList> drawList;
+
+        // used to handle loading of PagedLOD external children.
+        ref_ptr<DatabasePager> databasePager;
+        ref_ptr<CulledPagedLODs> culledPagedLODs;
+
+        ref_ptr<FrameStamp> frameStamp;
+        ref_ptr<State> state;
+
+        bool prefetch = false;
+        dvec3 prefetchEyeOffset;
+
+    protected:
+        static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+        struct StateInfo
+        {
+            uint32_t rank = 0;        // order in which the StateCommand was first encountered, used for the sort key
+            bool transparent = false; // GraphicsPipeline enables blending
+        };
+
+        void _addCommand(const Command& command);
+        const StateInfo& _getStateInfo(const StateCommand* stateCommand);
+
+        template<class T>
+        void _traverseBound(const T& node, const dsphere& bound);
+
+        // indices of the current state snapshot and modelview matrix in the drawList, invalidIndex when they have changed since the last Command was added
+        uint32_t _stateIndex = invalidIndex;
+        uint32_t _matrixIndex = invalidIndex;
+
+        // index in drawList->drawCommands of the first Command of the DrawItem being added, invalidIndex when no DrawItem is in progress,
+        // and the bin of the DrawItem once a drawable Command has been added to it, nullptr while it only has binds
+        uint32_t _drawItemBegin = invalidIndex;
+        std::vector<DrawItem>* _drawItemBin = nullptr;
+
+        // eye space depth of the nearest enclosing bounding sphere
+        double _depth = 0.0;
+        bool _depthValid = false;
+
+        std::unordered_map<const StateCommand*, StateInfo> _stateInfos;
+
+        // indices of the visible children of the BatchCullGroup being traversed, nested BatchCullGroup append their indices after those of their parents
+        std::vector<uint32_t> _visibleIndices;
     };
 } // namespace vsg
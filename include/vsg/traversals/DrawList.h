@@ -0,0 +1,81 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Inherit.h>
+#include <vsg/maths/mat4.h>
+
+#include <vector>
+
+namespace vsg
+{
+
+    // forward declare
+    class Command;
+    class StateCommand;
+
+    /// DrawCommand is a Command to dispatch along with the state and modelview matrix it's to be dispatched with.
+    struct DrawCommand
+    {
+        const Command* command = nullptr;
+        uint32_t stateIndex = 0;  // index of the first of DrawList::numSlots entries in DrawList::stateCommands
+        uint32_t matrixIndex = 0; // index into DrawList::modelviewMatrices
+    };
+
+    /// DrawItem is the unit that the DrawList sorts, a drawable Command such as a Commands, Geometry, VertexIndexDraw or DrawIndexed along with the
+    /// BindVertexBuffers, BindIndexBuffer and other bind Commands that precede it in the scene graph. Its DrawCommand are contiguous in DrawList::drawCommands
+    /// and are recorded in scene graph order, so binds are never separated from the draws that use them.
+    struct DrawItem
+    {
+        uint64_t sortKey = 0; // pipeline rank, descriptor set rank and depth, used to order the opaque bin
+        double depth = 0.0;   // eye space distance in front of the eye point
+        uint32_t first = 0;   // index of the first DrawCommand in DrawList::drawCommands
+        uint32_t count = 0;   // number of DrawCommand
+    };
+
+    /// DrawList is the output of the CullTraversal, the visible DrawItem sorted into an opaque and a transparent bin that are recorded by RecordTraversal::apply(const DrawList&).
+    /// Consecutive DrawCommand with the same state and modelview matrix share entries in stateCommands and modelviewMatrices, so the DrawCommand themselves stay compact.
+    class VSG_DECLSPEC DrawList : public Inherit<Object, DrawList>
+    {
+    public:
+        explicit DrawList(uint32_t in_numSlots = 3);
+
+        using DrawItems = std::vector<DrawItem>;
+
+        uint32_t numSlots;
+
+        /// Commands of all the DrawItem, in the order they were culled.
+        std::vector<DrawCommand> drawCommands;
+
+        /// state snapshots, numSlots entries per snapshot with nullptr for slots that have no state assigned.
+        std::vector<const StateCommand*> stateCommands;
+        std::vector<dmat4> modelviewMatrices;
+
+        DrawItems opaqueBin;
+        DrawItems transparentBin;
+
+        /// clear the draw items and snapshots, retaining the allocated memory for reuse by the next CullTraversal.
+        void clear();
+
+        /// sort the opaque bin by pipeline, descriptor set then front to back, and the transparent bin back to front.
+        /// The sorts are stable so DrawItem with the same key, such as consecutive DrawItem in the same Group, are recorded in their scene graph order.
+        void sort();
+
+        size_t size() const { return opaqueBin.size() + transparentBin.size(); }
+
+    protected:
+        virtual ~DrawList();
+    };
+    VSG_type_name(vsg::DrawList);
+
+} // namespace vsg
@@ -12,7 +12,11 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <chrono>
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 #include <vsg/core/Object.h>
 #include <vsg/maths/mat4.h>
 
@@ -28,6 +32,7 @@ namespace vsg
     class StateGroup;
     class CullGroup;
     class CullNode;
+    class BatchCullGroup;
     class MatrixTransform;
     class Command;
     class Commands;
@@ -36,6 +41,10 @@ namespace vsg
     class DatabasePager;
     class FrameStamp;
     class CulledPagedLODs;
+    class DrawList;
+    class CullTraversal;
+    class Camera;
+    class RenderGraph;
 
     class VSG_DECLSPEC RecordTraversal : public Object
     {
@@ -54,6 +63,7 @@ namespace vsg
         void apply(const PagedLOD& pagedLOD);
         void apply(const CullGroup& cullGroup);
         void apply(const CullNode& cullNode);
+        void apply(const BatchCullGroup& batchCullGroup);
 
         // Vulkan nodes
         void apply(const MatrixTransform& mt);
@@ -61,11 +71,48 @@ namespace vsg
         void apply(const Commands& commands);
         void apply(const Command& command);
 
+        // record the DrawItem culled by a CullTraversal, only binding the state that changes between consecutive Commands.
+        void apply(const DrawList& drawList);
+
         // used to handle loading of PagedLOD external children.
         ref_ptr<DatabasePager> databasePager;
         ref_ptr<CulledPagedLODs> culledPagedLODs;
 
         ref_ptr<FrameStamp> frameStamp;
         ref_ptr<State> state;
+
+        // eye space displacement of the camera's extrapolated position, set by RenderGraph when DatabasePager::prefetchTime is non zero
+        // and used to request the PagedLOD high res subgraphs that will be required once the camera gets there.
+        bool prefetch = false;
+        dvec3 prefetchEyeOffset;
+
+        /// motion of each Camera at the previous frame, used by RenderGraph to extrapolate the camera position for prefetching.
+        /// Held by the RecordTraversal rather than the RenderGraph so that RenderGraph recorded from several threads don't share it.
+        struct CameraMotion
+        {
+            dvec3 previous_eye;
+            dvec3 eye_velocity;
+            std::chrono::steady_clock::time_point previous_time;
+        };
+        std::map<const Camera*, CameraMotion> cameraMotions;
+
+        /// CullTraversal that RenderGraph culls its children with when RenderGraph::useDrawList is set, created on first use.
+        ref_ptr<CullTraversal> cullTraversal;
+
+        /// RecordTraversal, and its CulledPagedLODs, for each range of children that RenderGraph records in parallel with its recordScheduler.
+        /// Like the cameraMotions, the cullTraversal, recordRanges and secondaryCommandBuffers are held by the RecordTraversal so that RenderGraph recorded from several threads don't share them.
+        struct RecordRange
+        {
+            ref_ptr<RecordTraversal> recordTraversal;
+            ref_ptr<CulledPagedLODs> culledPagedLODs;
+        };
+        std::vector<RecordRange> recordRanges;
+
+        /// secondary CommandBuffers that each RenderGraph records its ranges into, for each primary CommandBuffer, they can only be rerecorded when the primary CommandBuffer that executes them has completed.
+        std::map<std::pair<const RenderGraph*, const CommandBuffer*>, std::vector<ref_ptr<CommandBuffer>>> secondaryCommandBuffers;
+
+    protected:
+        // indices of the visible children of the BatchCullGroup being traversed, nested BatchCullGroup append their indices after those of their parents
+        std::vector<uint32_t> _visibleIndices;
     };
 } // namespace vsg
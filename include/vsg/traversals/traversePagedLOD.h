@@ -0,0 +1,202 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/DatabasePager.h>
+#include <vsg/nodes/PagedLOD.h>
+#include <vsg/threading/atomics.h>
+#include <vsg/ui/ApplicationEvent.h>
+#include <vsg/vk/State.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace vsg
+{
+
+    /// select the PagedLOD child to traverse and request the external children that are required from the DatabasePager.
+    /// Shared by the RecordTraversal and CullTraversal, the Traversal type must provide the state, frameStamp, databasePager, culledPagedLODs,
+    /// prefetch and prefetchEyeOffset members of the RecordTraversal.
+    template<class Traversal>
+    void traversePagedLOD(Traversal& traversal, const PagedLOD& plod)
+    {
+        auto bound = plod.getBound();
+
+        auto frameCount = traversal.frameStamp->frameCount;
+
+        // check if lod bounding sphere is in view frustum.
+        if (!traversal.state->intersect(bound))
+        {
+            if ((frameCount - plod.frameHighResLastUsed) > 1 && traversal.culledPagedLODs)
+            {
+                traversal.culledPagedLODs->highresCulled.emplace_back(&plod);
+            }
+
+            return;
+        }
+
+        const auto& proj = traversal.state->projectionMatrixStack.top();
+        const auto& mv = traversal.state->modelviewMatrixStack.top();
+        auto f = -proj[1][1];
+
+        auto z = mv[0][2] * bound.x + mv[1][2] * bound.y + mv[2][2] * bound.z + mv[3][2];
+        auto distance = std::abs(z);
+        auto rf = bound.r * f;
+
+        // mark the external children as in use so that the DatabasePager keeps them resident
+        auto externalChildUsed = [&]() {
+            auto previousHighResUsed = plod.frameHighResLastUsed.exchange(frameCount);
+            if (!traversal.culledPagedLODs) return;
+
+            if ((frameCount - previousHighResUsed) > 1)
+            {
+                plod.frameActiveRefreshed = frameCount;
+                traversal.culledPagedLODs->newHighresRequired.emplace_back(&plod);
+            }
+            else
+            {
+                // periodically report PagedLOD in continuous use so the DatabasePager can keep its activeList ordered by use
+                auto previousRefreshed = plod.frameActiveRefreshed.load();
+                if ((frameCount - previousRefreshed) >= traversal.culledPagedLODs->activeRefreshInterval && plod.frameActiveRefreshed.compare_exchange_strong(previousRefreshed, frameCount))
+                {
+                    traversal.culledPagedLODs->newHighresRequired.emplace_back(&plod);
+                }
+            }
+        };
+
+        // request an external child from the DatabasePager, with the priority computed by the DatabasePager::priorityPolicy
+        auto requestChild = [&](uint32_t childIndex, double screenHeightRatio, double priorityScale) {
+            double priority = screenHeightRatio;
+            if (traversal.databasePager->priorityPolicy)
+            {
+                PagingPriorityParameters parameters;
+                parameters.plod = &plod;
+                parameters.childIndex = childIndex;
+                parameters.screenHeightRatio = screenHeightRatio;
+
+                // error of the child that is drawn in place of the requested child, projected to screen space
+                const auto& children = plod.getChildren();
+                for (size_t i = childIndex + 1; i < children.size(); ++i)
+                {
+                    if (children[i].node)
+                    {
+                        if (distance > 0.0) parameters.screenSpaceError = children[i].geometricError * f / distance;
+                        break;
+                    }
+                }
+
+                // position of the bounding sphere centre in normalized device coordinates
+                auto ex = mv[0][0] * bound.x + mv[1][0] * bound.y + mv[2][0] * bound.z + mv[3][0];
+                auto ey = mv[0][1] * bound.x + mv[1][1] * bound.y + mv[2][1] * bound.z + mv[3][1];
+                auto cx = proj[0][0] * ex + proj[1][0] * ey + proj[2][0] * z + proj[3][0];
+                auto cy = proj[0][1] * ex + proj[1][1] * ey + proj[2][1] * z + proj[3][1];
+                auto cw = proj[0][3] * ex + proj[1][3] * ey + proj[2][3] * z + proj[3][3];
+                parameters.distanceFromViewCentre = (cw > 0.0) ? std::sqrt(cx * cx + cy * cy) / cw : 1.0;
+
+                // the requestTime is loaded after the requestCount as it's cleared before the requestCount, so it's 0 or the time of the current request
+                if (plod.requestCount.load() > 0)
+                {
+                    if (auto requestTime = plod.requestTime.load(); requestTime != 0)
+                    {
+                        parameters.timeRequested = std::max(0.0, std::chrono::duration<double, std::chrono::seconds::period>(traversal.frameStamp->time - time_point(clock::duration(requestTime))).count());
+                    }
+                }
+
+                priority = traversal.databasePager->priorityPolicy->priority(parameters);
+            }
+            priority *= priorityScale;
+
+            bool priorityIncreased = exchange_if_greater(plod.priority, priority);
+
+            auto previousRequestCount = plod.requestCount.fetch_add(1);
+            if (previousRequestCount == 0)
+            {
+                // we are first request so tell the databasePager about it
+                plod.requestChild = childIndex;
+                traversal.databasePager->request(ref_ptr<PagedLOD>(const_cast<PagedLOD*>(&plod)));
+            }
+            else
+            {
+                //std::cout<<"repeat request "<<&plod<<", "<<plod.requestCount.load()<<std::endl;;
+
+                // let the DatabasePager know so it can reposition the pending request in its queue
+                if (priorityIncreased && traversal.culledPagedLODs) traversal.culledPagedLODs->priorityIncreased.emplace_back(&plod);
+            }
+        };
+
+        // select the first visible child, children are ordered from highest to lowest resolution so at most one child is traversed.
+        // The first visible external child is requested if not already loaded, with the next visible child used in its place.
+        const auto& children = plod.getChildren();
+        bool externalChildVisible = false;
+        for (size_t i = 0; i < children.size(); ++i)
+        {
+            const auto& child = children[i];
+            auto cutoff = child.minimumScreenHeightRatio * distance;
+            bool child_visible = rf > cutoff;
+            if (child_visible)
+            {
+                if (!externalChildVisible && !child.filename.empty())
+                {
+                    externalChildVisible = true;
+                    externalChildUsed();
+
+                    if (!child.node && traversal.databasePager)
+                    {
+                        requestChild(static_cast<uint32_t>(i), rf / cutoff, 1.0);
+                    }
+                }
+
+                if (child.node)
+                {
+                    child.node->accept(traversal);
+                    break;
+                }
+            }
+        }
+
+        if (externalChildVisible) return;
+
+        if (traversal.prefetch && traversal.databasePager)
+        {
+            // check which child will be selected from the camera's extrapolated position, if it's an external child keep it active and request it at a reduced priority.
+            auto predictedDistance = std::abs(z - traversal.prefetchEyeOffset.z);
+            for (size_t i = 0; i < children.size(); ++i)
+            {
+                const auto& child = children[i];
+                auto predictedCutoff = child.minimumScreenHeightRatio * predictedDistance;
+                if (rf > predictedCutoff)
+                {
+                    if (!child.filename.empty())
+                    {
+                        externalChildUsed();
+
+                        if (!child.node)
+                        {
+                            requestChild(static_cast<uint32_t>(i), rf / predictedCutoff, traversal.databasePager->prefetchPriorityScale);
+                        }
+                        return;
+                    }
+
+                    if (child.node) break;
+                }
+            }
+        }
+
+        if (traversal.culledPagedLODs && ((frameCount - plod.frameHighResLastUsed) <= 1))
+        {
+            traversal.culledPagedLODs->highresCulled.emplace_back(&plod);
+        }
+    }
+
+} // namespace vsg
@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/nodes/Group.h>
+#include <vsg/threading/Affinity.h>
 #include <vsg/viewer/Camera.h>
 #include <vsg/viewer/Window.h>
 #include <vsg/vk/CommandBuffer.h>
@@ -20,6 +21,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 namespace vsg
 {
 
+    class CulledPagedLODs;
+
     class CommandGraph : public Inherit<Group, CommandGraph>
     {
     public:
@@ -34,6 +37,13 @@ namespace vsg
 
         ref_ptr<Window> window;
 
+        /// CPU affinity of the thread that records this CommandGraph when RecordAndSubmitTask::threading is enabled.
+        Affinity affinity;
+
+        /// when assigned the RecordTraversal reports culled PagedLOD here rather than to the DatabasePager::culledPagedLODs,
+        /// used by RecordAndSubmitTask to give each CommandGraph recorded in parallel its own container, merged into the DatabasePager's once recording has completed.
+        ref_ptr<CulledPagedLODs> culledPagedLODs;
+
         ref_ptr<Device> _device;
         int _queueFamily = -1;
         int _presentFamily = -1;
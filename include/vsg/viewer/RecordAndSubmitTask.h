@@ -18,6 +18,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/io/DatabasePager.h>
 
+#include <vsg/threading/OperationThreads.h>
+
 #include <vsg/viewer/CommandGraph.h>
 #include <vsg/viewer/Window.h>
 
@@ -38,6 +40,28 @@ namespace vsg
 
         ref_ptr<DatabasePager> databasePager;
         ref_ptr<Queue> queue; // assign in application for GraphicsQueue from device
+
+        /// record each CommandGraph on its own thread, with the thread's CPU affinity set from CommandGraph::affinity, rather than serially on the thread calling submit().
+        /// submit() waits on a Latch for all the CommandGraphs to be recorded before submitting the command buffers, in the order of the commandGraphs list, to the queue.
+        bool threading = false;
+
+    protected:
+        virtual ~RecordAndSubmitTask();
+
+        void _recordThreaded(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameStamp> frameStamp);
+        void _stopThreads();
+
+        struct RecordThread
+        {
+            ref_ptr<CommandGraph> commandGraph;
+            ref_ptr<OperationThreads> operationThreads;
+            ref_ptr<CulledPagedLODs> culledPagedLODs;
+            CommandBuffers recordedCommandBuffers;
+            Affinity affinity;
+        };
+
+        std::vector<RecordThread> _recordThreads;
+        ref_ptr<Latch> _recordLatch;
     };
 
 } // namespace vsg
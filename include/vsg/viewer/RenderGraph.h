@@ -13,6 +13,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/nodes/Group.h>
+#include <vsg/threading/TaskScheduler.h>
+#include <vsg/ui/UIEvent.h>
 
 #include <vsg/viewer/Camera.h>
 #include <vsg/viewer/Window.h>
@@ -39,5 +41,20 @@ namespace vsg
         // windopw extent at previous frame
         const uint32_t invalid_dimension = std::numeric_limits<uint32_t>::max();
         mutable VkExtent2D previous_extent = VkExtent2D{invalid_dimension, invalid_dimension};
+
+        /// when assigned, the children of the RenderGraph are split into contiguous ranges that are recorded in parallel on the TaskScheduler's worker threads and the calling thread.
+        /// Each range is recorded by its own RecordTraversal, with a copy of the State, into its own secondary CommandBuffer, and the secondary CommandBuffers are executed in order
+        /// from the primary CommandBuffer. If the RenderGraph has a single child that is a plain Group the Group's children are split instead.
+        ref_ptr<TaskScheduler> recordScheduler;
+
+        /// maximum number of ranges the children are split into when recording with the recordScheduler, 0 uses the number of worker threads plus one for the calling thread.
+        uint32_t maxRecordRanges = 0;
+
+        /// when true, the children of the RenderGraph are culled by the RecordTraversal's CullTraversal into its DrawList, which is sorted then recorded in place of
+        /// traversing the children, reducing the pipeline and descriptor set binds. Takes precedence over the recordScheduler.
+        bool useDrawList = false;
+
+    protected:
+        bool _recordSecondaryCommandBuffers(RecordTraversal& dispatchTraversal, VkRenderPassBeginInfo& renderPassInfo) const;
     };
 } // namespace vsg
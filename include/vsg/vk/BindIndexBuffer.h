@@ -45,6 +45,9 @@ namespace vsg
 
         void compile(Context& context) override;
 
+        /// release the Vulkan buffers created by compile(), a subsequent compile() will recreate them.
+        void release();
+
         void dispatch(CommandBuffer& commandBuffer) const override;
 
     protected:
@@ -24,12 +24,13 @@ namespace vsg
     class VSG_DECLSPEC CommandBuffer : public Inherit<Object, CommandBuffer>
     {
     public:
-        CommandBuffer(Device* device, CommandPool* commandPool, VkCommandBuffer commandBuffer, VkCommandBufferUsageFlags flags);
+        CommandBuffer(Device* device, CommandPool* commandPool, VkCommandBuffer commandBuffer, VkCommandBufferUsageFlags flags, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
         using Result = vsg::Result<CommandBuffer, VkResult, VK_SUCCESS>;
-        static Result create(Device* device, CommandPool* commandPool, VkCommandBufferUsageFlags flags);
+        static Result create(Device* device, CommandPool* commandPool, VkCommandBufferUsageFlags flags, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
         VkCommandBufferUsageFlags flags() const { return _flags; }
+        VkCommandBufferLevel level() const { return _level; }
 
         const VkCommandBuffer* data() const { return &_commandBuffer; }
 
@@ -50,15 +51,65 @@ namespace vsg
 
         ref_ptr<ScratchMemory> scratchMemory;
 
+        /// when true, pipeline, descriptor set, vertex buffer and index buffer binds that match the state already bound in the command buffer are skipped.
+        /// The bound state is only known to the CommandBuffer if resetBoundState() is called each time recording begins, as done by CommandGraph and RenderGraph,
+        /// so it's disabled by default for command buffers recorded by applications.
+        bool elideRedundantBinds = false;
+
+        struct BindStatistics
+        {
+            uint32_t numPipelineBinds = 0;
+            uint32_t numPipelineBindsElided = 0;
+            uint32_t numDescriptorSetBinds = 0;
+            uint32_t numDescriptorSetBindsElided = 0;
+            uint32_t numVertexBufferBinds = 0;
+            uint32_t numVertexBufferBindsElided = 0;
+            uint32_t numIndexBufferBinds = 0;
+            uint32_t numIndexBufferBindsElided = 0;
+        };
+
+        /// number of binds dispatched and elided since resetBoundState() was last called.
+        BindStatistics bindStatistics;
+
+        /// clear the record of the bound state and the bindStatistics, call when recording begins and after the bound state is invalidated, such as by vkCmdExecuteCommands.
+        void resetBoundState();
+
+        /// bind commands used by the StateCommand and Command implementations, eliding the bind if elideRedundantBinds is true and the same state is already bound.
+        void bindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline, VkPipelineLayout pipelineLayout);
+        void bindDescriptorSets(VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* descriptorSets);
+        void bindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers, const VkDeviceSize* offsets);
+        void bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
+
     protected:
         virtual ~CommandBuffer();
 
         VkCommandBuffer _commandBuffer;
         VkCommandBufferUsageFlags _flags;
+        VkCommandBufferLevel _level;
         std::atomic_uint _numDependentSubmissions{0};
         ref_ptr<Device> _device;
         ref_ptr<CommandPool> _commandPool;
         VkPipelineLayout _currentPipelineLayout;
+
+        // state bound in the command buffer, only the graphics and compute bind points are tracked
+        struct BoundDescriptorSet
+        {
+            VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        };
+
+        struct BoundVertexBuffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+        };
+
+        VkPipeline _boundPipelines[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+        std::vector<BoundDescriptorSet> _boundDescriptorSets[2];
+        std::vector<BoundVertexBuffer> _boundVertexBuffers;
+        VkBuffer _boundIndexBuffer = VK_NULL_HANDLE;
+        VkDeviceSize _boundIndexBufferOffset = 0;
+        VkIndexType _boundIndexType = VK_INDEX_TYPE_UINT16;
     };
 
     using CommandBuffers = std::vector<ref_ptr<CommandBuffer>>;
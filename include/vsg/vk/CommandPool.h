@@ -19,7 +19,7 @@ namespace vsg
     class VSG_DECLSPEC CommandPool : public Inherit<Object, CommandPool>
     {
     public:
-        CommandPool(VkCommandPool CommandPool, Device* device, AllocationCallbacks* allocator = nullptr);
+        CommandPool(VkCommandPool CommandPool, Device* device, AllocationCallbacks* allocator = nullptr, uint32_t queueFamilyIndex = 0);
 
         using Result = vsg::Result<CommandPool, VkResult, VK_SUCCESS>;
         static Result create(Device* device, uint32_t queueFamilyIndex, AllocationCallbacks* allocator = nullptr);
@@ -29,12 +29,15 @@ namespace vsg
         Device* getDevice() { return _device; }
         const Device* getDevice() const { return _device; }
 
+        uint32_t getQueueFamilyIndex() const { return _queueFamilyIndex; }
+
     protected:
         virtual ~CommandPool();
 
         VkCommandPool _commandPool;
         ref_ptr<Device> _device;
         ref_ptr<AllocationCallbacks> _allocator;
+        uint32_t _queueFamilyIndex;
     };
 
 } // namespace vsg
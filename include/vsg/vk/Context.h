@@ -14,6 +14,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <deque>
 #include <memory>
+#include <mutex>
 
 #include <vsg/core/Object.h>
 #include <vsg/core/ScratchMemory.h>
@@ -71,6 +72,10 @@ namespace vsg
         using CopyQueue = std::deque<CopyPair>;
 
         CopyQueue bufferDataToCopy;
+
+    protected:
+        // serializes the reserve and compute methods as the MemoryBufferPools are shared between the Context of each compile thread
+        mutable std::mutex _mutex;
     };
 
     class CopyAndReleaseBufferDataCommand : public Command
@@ -165,6 +170,10 @@ namespace vsg
         ref_ptr<MemoryBufferPools> deviceMemoryBufferPools;
         ref_ptr<MemoryBufferPools> stagingMemoryBufferPools;
 
+        // running total of the memory reserved from deviceMemoryBufferPools through this Context, used by DatabasePager to measure the GPU memory usage of compiled subgraphs.
+        // used by BufferData.cpp, ImageData.cpp
+        VkDeviceSize deviceMemoryReserved = 0;
+
         // raytracing
         VkDeviceSize scratchBufferSize;
         std::vector<ref_ptr<BuildAccelerationStructureCommand>> buildAccelerationStructureCommands;
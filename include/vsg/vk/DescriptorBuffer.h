@@ -36,6 +36,9 @@ namespace vsg
 
         void compile(Context& context) override;
 
+        /// release the Vulkan buffers created by compile(), a subsequent compile() will recreate them.
+        void release();
+
         void assignTo(Context& context, VkWriteDescriptorSet& wds) const override;
 
         uint32_t getNumDescriptors() const override;
@@ -127,6 +127,9 @@ namespace vsg
         // compile the Vulkan object, context parameter used for Device
         void compile(Context& context) override;
 
+        /// release the cached Vulkan handles, the DescriptorSet(s) themselves are left to be released separately as they may be shared.
+        void release() { _vulkanData.clear(); }
+
         void dispatch(CommandBuffer& commandBuffer) const override;
 
     protected:
@@ -194,6 +197,9 @@ namespace vsg
         // compile the Vulkan object, context parameter used for Device
         void compile(Context& context) override;
 
+        /// release the cached Vulkan handles, the DescriptorSet(s) themselves are left to be released separately as they may be shared.
+        void release() { _vulkanData.clear(); }
+
         void dispatch(CommandBuffer& commandBuffer) const override;
 
     protected:
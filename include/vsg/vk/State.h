@@ -12,6 +12,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/maths/batchIntersect.h>
 #include <vsg/maths/plane.h>
 #include <vsg/vk/BindIndexBuffer.h>
 #include <vsg/vk/BindVertexBuffers.h>
@@ -249,6 +250,29 @@ namespace vsg
             pushFrustum();
         }
 
+        /// copy the state stacks, matrices and frustum from rhs so that a RecordTraversal recording into another CommandBuffer, such as a secondary CommandBuffer,
+        /// carries on from where rhs is. All the inherited state is marked as dirty so that it's dispatched to the new CommandBuffer before the first draw.
+        void inherit(const State& rhs)
+        {
+            stateStacks = rhs.stateStacks;
+            for (auto& stateStack : stateStacks)
+            {
+                stateStack.dirty = stateStack.size() > 0;
+            }
+
+            projectionMatrixStack = rhs.projectionMatrixStack;
+            projectionMatrixStack.dirty = true;
+
+            modelviewMatrixStack = rhs.modelviewMatrixStack;
+            modelviewMatrixStack.dirty = true;
+
+            _frustumUnit = rhs._frustumUnit;
+            _frustumProjected = rhs._frustumProjected;
+            _frustumStack = rhs._frustumStack;
+
+            dirty = true;
+        }
+
         inline void dispatch()
         {
             if (dirty)
@@ -299,6 +323,19 @@ namespace vsg
         {
             return vsg::intersect(_frustumStack.top(), s);
         }
+
+        /// test a batch of bounding spheres against the current frustum, writing the indices of the visible spheres to visible and returning the number written.
+        uint32_t intersect(const double* x, const double* y, const double* z, const double* radius, uint32_t count, uint32_t* visible)
+        {
+            const auto& polytope = _frustumStack.top();
+#if USE_DOUBLE_MATRIX_STACK
+            return vsg::intersect(polytope.data(), POLYTOPE_SIZE, x, y, z, radius, count, visible);
+#else
+            std::array<dplane, POLYTOPE_SIZE> planes;
+            for (size_t i = 0; i < POLYTOPE_SIZE; ++i) planes[i] = polytope[i];
+            return vsg::intersect(planes.data(), POLYTOPE_SIZE, x, y, z, radius, count, visible);
+#endif
+        }
     };
 
 } // namespace vsg
@@ -14,6 +14,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/core/External.h>
 #include <vsg/core/Objects.h>
 
+#include <vsg/nodes/BatchCullGroup.h>
 #include <vsg/nodes/Commands.h>
 #include <vsg/nodes/CullGroup.h>
 #include <vsg/nodes/CullNode.h>
@@ -351,6 +352,10 @@ void ConstVisitor::apply(const CullNode& value)
 {
     apply(static_cast<const Node&>(value));
 }
+void ConstVisitor::apply(const BatchCullGroup& value)
+{
+    apply(static_cast<const Node&>(value));
+}
 void ConstVisitor::apply(const MatrixTransform& value)
 {
     apply(static_cast<const Group&>(value));
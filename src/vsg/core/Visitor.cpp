@@ -14,6 +14,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/core/Objects.h>
 #include <vsg/core/Visitor.h>
 
+#include <vsg/nodes/BatchCullGroup.h>
 #include <vsg/nodes/Commands.h>
 #include <vsg/nodes/CullGroup.h>
 #include <vsg/nodes/CullNode.h>
@@ -350,6 +351,10 @@ void Visitor::apply(CullNode& value)
 {
     apply(static_cast<Node&>(value));
 }
+void Visitor::apply(BatchCullGroup& value)
+{
+    apply(static_cast<Node&>(value));
+}
 void Visitor::apply(MatrixTransform& value)
 {
     apply(static_cast<Group&>(value));
@@ -12,10 +12,20 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/io/DatabasePager.h>
 #include <vsg/io/read.h>
+#include <vsg/nodes/Geometry.h>
+#include <vsg/nodes/Group.h>
+#include <vsg/nodes/StateGroup.h>
+#include <vsg/nodes/VertexIndexDraw.h>
 #include <vsg/threading/atomics.h>
 #include <vsg/ui/ApplicationEvent.h>
+#include <vsg/vk/BindIndexBuffer.h>
+#include <vsg/vk/BindVertexBuffers.h>
+#include <vsg/vk/DescriptorBuffer.h>
+#include <vsg/vk/DescriptorImage.h>
+#include <vsg/vk/DescriptorSet.h>
 
 #include <iostream>
+#include <limits>
 
 using namespace vsg;
 
@@ -24,115 +34,307 @@ using namespace vsg;
 
 /////////////////////////////////////////////////////////////////////////
 //
-// DatabasePager
+// ComputeDataSize sums the size of all the Data referenced by a subgraph, Data shared between parts of the subgraph is only counted once.
 //
-DatabaseQueue::DatabaseQueue(ref_ptr<Active> in_active) :
-    _active(in_active)
+struct ComputeDataSize : public ConstVisitor
 {
-}
+    uint64_t size = 0;
+    std::set<const Data*> visited;
 
-DatabaseQueue::~DatabaseQueue()
-{
-}
+    void add(const Data* data)
+    {
+        if (data && visited.insert(data).second) size += data->dataSize();
+    }
 
-void DatabaseQueue::add(ref_ptr<PagedLOD> plod)
-{
-    // std::cout<<"DatabaseQueue::add("<<plod<<") status = "<<plod->requestStatus.load()<<std::endl;
+    void add(const DataList& dataList)
+    {
+        for (auto& data : dataList) add(data);
+    }
 
-    std::scoped_lock lock(_mutex);
-    _queue.emplace_back(plod);
-    _cv.notify_one();
-}
+    void apply(const Node& node) override
+    {
+        node.traverse(*this);
+    }
 
-void DatabaseQueue::add_then_reset(ref_ptr<PagedLOD>& plod)
-{
-    std::scoped_lock lock(_mutex);
-    _queue.emplace_back(plod);
-    _cv.notify_one();
-    plod = nullptr;
-}
+    void apply(const StateGroup& stateGroup) override
+    {
+        for (auto& stateCommand : stateGroup.getStateCommands()) stateCommand->accept(*this);
+        stateGroup.traverse(*this);
+    }
 
-void DatabaseQueue::add(Nodes& nodes)
-{
-    std::scoped_lock lock(_mutex);
+    void apply(const DescriptorSet& descriptorSet) override
+    {
+        descriptorSet.traverse(*this);
+    }
+
+    void apply(const Descriptor& descriptor) override
+    {
+        if (auto descriptorImage = dynamic_cast<const DescriptorImage*>(&descriptor); descriptorImage)
+        {
+            for (auto& samplerImage : descriptorImage->getSamplerImages()) add(samplerImage.data);
+        }
+        else if (auto descriptorBuffer = dynamic_cast<const DescriptorBuffer*>(&descriptor); descriptorBuffer)
+        {
+            add(descriptorBuffer->getDataList());
+        }
+    }
 
-    _queue.insert(_queue.end(), nodes.begin(), nodes.end());
+    void apply(const Geometry& geometry) override
+    {
+        add(geometry.arrays);
+        add(geometry.indices);
+        geometry.traverse(*this);
+    }
 
-    _cv.notify_one();
-}
+    void apply(const VertexIndexDraw& vid) override
+    {
+        add(vid.arrays);
+        add(vid.indices);
+    }
+
+    void apply(const BindVertexBuffers& bvb) override
+    {
+        add(bvb.getArrays());
+    }
+
+    void apply(const BindIndexBuffer& bib) override
+    {
+        add(bib.getIndices());
+    }
+};
 
-ref_ptr<PagedLOD> DatabaseQueue::take_when_avilable()
+/////////////////////////////////////////////////////////////////////////
+//
+// ReleaseVulkanObjects releases the Vulkan buffers and images of a subgraph so that it can be retained in CPU memory and recompiled later.
+// Pipelines, layouts and any node, command, DescriptorSet or Descriptor referenced from elsewhere are left untouched as they may be shared with subgraphs still in use.
+//
+struct ReleaseVulkanObjects : public Visitor
 {
-    //std::cout<<"DatabaseQueue::take_when_avilable() A _identifier = "<<_identifier<<" size = "<<_queue.size()<<std::endl;
+    void apply(Node& node) override
+    {
+        node.traverse(*this);
+    }
 
-    std::chrono::duration waitDuration = std::chrono::milliseconds(100);
-    std::unique_lock lock(_mutex);
+    void apply(StateGroup& stateGroup) override
+    {
+        for (auto& stateCommand : stateGroup.getStateCommands()) stateCommand->accept(*this);
+        stateGroup.traverse(*this);
+    }
 
-    // wait to the conditional variable signals that an operation has been added
-    while (_queue.empty() && *_active)
+    void apply(BindDescriptorSet& bds) override
     {
-        //std::cout<<"   Waiting on condition variable B _identifier = "<<_identifier<<" size = "<<_queue.size()<<std::endl;
-        _cv.wait_for(lock, waitDuration);
+        if (bds.referenceCount() > 1) return;
+
+        bds.release();
+        bds.traverse(*this);
     }
 
-    // if the threads we are associated with should no longer running go for a quick exit and return nothing.
-    if (_queue.empty() || !(*_active))
+    void apply(BindDescriptorSets& bds) override
     {
-        //std::cout<<"DatabaseQueue::take_when_avilable() C _identifier = "<<_identifier<<" empty"<<std::endl;
-        return {};
+        if (bds.referenceCount() > 1) return;
+
+        bds.release();
+        bds.traverse(*this);
     }
 
-    //std::cout<<"DatabaseQueue::take_when_avilable() D _identifier = "<<_identifier<<" "<<_queue.size()<<std::endl;
+    void apply(DescriptorSet& descriptorSet) override
+    {
+        if (descriptorSet.referenceCount() > 1) return;
 
-#if 1
+        // releasing the DescriptorSet's implementation drops its references to the Descriptor so they can be checked for sharing
+        descriptorSet.release();
+        descriptorSet.traverse(*this);
+    }
 
-    // find the OagedLOD with the highest priority;
-    auto itr = _queue.begin();
-    auto highest_itr = itr++;
+    void apply(Descriptor& descriptor) override
+    {
+        if (descriptor.referenceCount() > 1) return;
 
-    for (; itr != _queue.end(); ++itr)
+        if (auto descriptorImage = dynamic_cast<DescriptorImage*>(&descriptor); descriptorImage)
+            descriptorImage->release();
+        else if (auto descriptorBuffer = dynamic_cast<DescriptorBuffer*>(&descriptor); descriptorBuffer)
+            descriptorBuffer->release();
+    }
+
+    void apply(Geometry& geometry) override
     {
-        if ((*highest_itr)->priority > (*itr)->priority) highest_itr = itr;
+        if (geometry.referenceCount() > 1) return;
+
+        geometry.release();
     }
 
-    ref_ptr<PagedLOD> plod = *highest_itr;
-    _queue.erase(highest_itr);
+    void apply(VertexIndexDraw& vid) override
+    {
+        if (vid.referenceCount() > 1) return;
 
-    //std::cout<<"Returning "<<plod.get()<<std::dec<<" variable _identifier = "<<_identifier<<" size = "<<_queue.size()<<std::endl;
+        vid.release();
+    }
 
-#else
-    // remove and return the head of the queue
-    ref_ptr<PagedLOD> plod = _queue.front();
-    _queue.erase(_queue.begin());
-#endif
-    return plod;
+    void apply(BindVertexBuffers& bvb) override
+    {
+        if (bvb.referenceCount() > 1) return;
+
+        bvb.release();
+    }
+
+    void apply(BindIndexBuffer& bib) override
+    {
+        if (bib.referenceCount() > 1) return;
+
+        bib.release();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////
+//
+// ExpiredSubgraphs holds the subgraphs detached from an expired PagedLOD along with the filenames they were read from,
+// so that the compile thread can move them into the DatabasePager::subgraphCache. Subgraphs with an empty filename are just deleted.
+//
+class ExpiredSubgraphs : public Inherit<Group, ExpiredSubgraphs>
+{
+public:
+    void add(const Path& filename, ref_ptr<Node> subgraph)
+    {
+        filenames.push_back(filename);
+        addChild(subgraph);
+    }
+
+    Paths filenames;
+};
+
+/////////////////////////////////////////////////////////////////////////
+//
+// PagingPriorityPolicy
+//
+double PagingPriorityPolicy::priority(const PagingPriorityParameters& parameters) const
+{
+    return parameters.screenHeightRatio;
 }
 
-DatabaseQueue::Nodes DatabaseQueue::take_all_when_available()
+double ScreenSpaceErrorPriorityPolicy::priority(const PagingPriorityParameters& parameters) const
 {
-    std::chrono::duration waitDuration = std::chrono::milliseconds(100);
+    // both the screenSpaceError relative to the maximum and the screenHeightRatio are > 1.0 when the requested child is required
+    double error = (parameters.screenSpaceError > 0.0 && maximumScreenSpaceError > 0.0) ? (parameters.screenSpaceError / maximumScreenSpaceError) : parameters.screenHeightRatio;
+    double centreFactor = 1.0 + viewCentreWeight * std::max(0.0, 1.0 - parameters.distanceFromViewCentre);
+    double timeFactor = 1.0 + timeRequestedWeight * parameters.timeRequested;
+    return error * centreFactor * timeFactor;
+}
 
-    std::unique_lock lock(_mutex);
+/////////////////////////////////////////////////////////////////////////
+//
+// SubgraphCache
+//
+SubgraphCache::SubgraphCache(uint64_t in_memoryBudget) :
+    _memoryBudget(in_memoryBudget)
+{
+}
+
+SubgraphCache::~SubgraphCache()
+{
+}
 
-    // wait to the conditional variable signals that an operation has been added
-    while (_queue.empty() && *_active)
+void SubgraphCache::add(const Path& filename, ref_ptr<Node> subgraph, uint64_t size)
+{
+    Entries discarded;
     {
-        //std::cout<<"take_all_when_available() _identifier = "<<_identifier<<" Waiting on condition variable"<<_queue.size()<<std::endl;
-        _cv.wait_for(lock, waitDuration);
+        std::scoped_lock lock(_mutex);
+
+        if (auto itr = _entryMap.find(filename); itr != _entryMap.end())
+        {
+            _memoryUsage -= itr->second->size;
+            discarded.splice(discarded.end(), _entries, itr->second);
+            _entryMap.erase(itr);
+        }
+
+        _entries.push_back(Entry{filename, subgraph, size});
+        _entryMap[filename] = std::prev(_entries.end());
+        _memoryUsage += size;
+
+        _trim(discarded);
     }
 
-    // if the threads we are associated with should no longer running go for a quick exit and return nothing.
-    if (!*_active)
+    // discarded subgraphs are deleted here, after the mutex has been unlocked
+}
+
+ref_ptr<Node> SubgraphCache::take(const Path& filename, uint64_t& size)
+{
+    std::scoped_lock lock(_mutex);
+
+    auto itr = _entryMap.find(filename);
+    if (itr == _entryMap.end()) return {};
+
+    auto entry_itr = itr->second;
+    ref_ptr<Node> subgraph = entry_itr->subgraph;
+    size = entry_itr->size;
+
+    _memoryUsage -= entry_itr->size;
+    _entries.erase(entry_itr);
+    _entryMap.erase(itr);
+
+    return subgraph;
+}
+
+void SubgraphCache::clear()
+{
+    Entries discarded;
     {
-        return {};
+        std::scoped_lock lock(_mutex);
+        discarded.swap(_entries);
+        _entryMap.clear();
+        _memoryUsage = 0;
     }
+}
 
-    //std::cout<<"DatabaseQueue::take_all_when_avilable() "<<_queue.size()<<std::endl;
+void SubgraphCache::setMemoryBudget(uint64_t budget)
+{
+    Entries discarded;
+    {
+        std::scoped_lock lock(_mutex);
+        _memoryBudget = budget;
+        _trim(discarded);
+    }
+}
+
+uint64_t SubgraphCache::getMemoryBudget() const
+{
+    std::scoped_lock lock(_mutex);
+    return _memoryBudget;
+}
+
+uint64_t SubgraphCache::getMemoryUsage() const
+{
+    std::scoped_lock lock(_mutex);
+    return _memoryUsage;
+}
+
+size_t SubgraphCache::size() const
+{
+    std::scoped_lock lock(_mutex);
+    return _entries.size();
+}
 
-    // remove and return the head of the queue
-    Nodes nodes;
-    nodes.swap(_queue);
-    return nodes;
+void SubgraphCache::_trim(Entries& discarded)
+{
+    while (!_entries.empty() && _memoryUsage > _memoryBudget)
+    {
+        auto& entry = _entries.front();
+        _memoryUsage -= entry.size;
+        _entryMap.erase(entry.filename);
+        discarded.splice(discarded.end(), _entries, _entries.begin());
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+// DatabaseQueue
+//
+DatabaseQueue::DatabaseQueue(ref_ptr<Active> in_active) :
+    Inherit(in_active, QueuePolicy::Priority)
+{
+}
+
+DatabaseQueue::~DatabaseQueue()
+{
 }
 
 /////////////////////////////////////////////////////////////////////////
@@ -144,11 +346,27 @@ DatabasePager::DatabasePager()
     if (!_active) _active = Active::create();
 
     culledPagedLODs = CulledPagedLODs::create();
+    statistics = DatabasePagerStatistics::create();
+    priorityPolicy = PagingPriorityPolicy::create();
 
     _requestQueue = DatabaseQueue::create(_active);
     _compileQueue = DatabaseQueue::create(_active);
     _toMergeQueue = DatabaseQueue::create(_active);
 
+    // read stage, PagedLOD whose high res child has gone out of use since the request was made are discarded without being read
+    _readStage = PipelineStage<PagedLOD>::create(_requestQueue, [this](PipelineStage<PagedLOD>& stage, DatabaseQueue::Nodes& nodes, uint32_t) { _read(nodes, *stage.output); });
+    _readStage->output = _compileQueue;
+    _readStage->cancelled = [this](const PagedLOD& plod) { return (frameCount - plod.frameHighResLastUsed.load()) > 1; };
+    _readStage->discarded = [this](ref_ptr<PagedLOD>& plod) {
+        ++statistics->numReadRequestsCancelled;
+        requestDiscarded(plod);
+    };
+
+    // compile stage, takes all the PagedLOD available so that they can be compiled and transferred as a batch
+    _compileStage = PipelineStage<PagedLOD>::create(_compileQueue, [this](PipelineStage<PagedLOD>& stage, DatabaseQueue::Nodes& nodes, uint32_t) { _compile(nodes, *stage.output); });
+    _compileStage->output = _toMergeQueue;
+    _compileStage->maxBatchSize = 0;
+
     pagedLODContainer = PagedLODContainer::create(4000);
 }
 
@@ -158,270 +376,414 @@ DatabasePager::~DatabasePager()
 
     _active->active.exchange(false);
 
-    for (auto& thread : _readThreads)
+    // wake any threads blocked on the queues or the CompileTraversal pool so they see the cleared active flag straight away
+    _requestQueue->release();
+    _compileQueue->release();
+    _toMergeQueue->release();
     {
-        thread.join();
+        std::scoped_lock lock(_compileTraversalMutex);
+        _compileTraversalAvailable.notify_all();
+        _compileTraversalDispatchedCondition.notify_all();
     }
 
-    for (auto& thread : _compileThreads)
+    _readStage->stop();
+    _compileStage->stop();
+
+    if (_completionThread.joinable())
     {
-        thread.join();
+        _completionThread.join();
     }
 }
 
 void DatabasePager::start()
 {
-    int numReadThreads = 4;
-    int numCompileThreads = 1;
+    _readStage->affinity = readAffinity;
+    _readStage->threadPriority = readThreadPriority;
+    _compileStage->affinity = compileAffinity;
+    _compileStage->threadPriority = compileThreadPriority;
 
     //
     // set up read thread(s)
     //
-    auto read = [](ref_ptr<DatabaseQueue> requestQueue, ref_ptr<DatabaseQueue> compileQueue, ref_ptr<Active> a, DatabasePager& databasePager) {
-        //std::cout<<"Started DatabaseThread read thread"<<std::endl;
-
-        while (*(a))
-        {
-            auto plod = requestQueue->take_when_avilable();
-            if (plod)
-            {
-                uint64_t frameDelta = databasePager.frameCount - plod->frameHighResLastUsed.load();
-                if (frameDelta > 1 || !compare_exchange(plod->requestStatus, PagedLOD::ReadRequest, PagedLOD::Reading))
-                {
-                    // std::cout<<"Expire read request"<<std::endl;
-                    databasePager.requestDiscarded(plod);
-                    continue;
-                }
+    _readStage->setConcurrencyLimit(std::max(numReadThreads, 1u));
 
-                //std::cout<<"    reading "<<plod->filename<<", "<<plod->requestCount.load()<<std::endl;
+    //
+    // set up compile thread(s)
+    //
+    _setNumCompileThreads(std::max(numCompileThreads, 1u));
+}
 
-                auto subgraph = vsg::read_cast<vsg::Node>(plod->filename, plod->options);
+void DatabasePager::_read(DatabaseQueue::Nodes& nodes, StageQueue<PagedLOD>& output)
+{
+    for (auto& plod : nodes)
+    {
+        if (!compare_exchange(plod->requestStatus, PagedLOD::ReadRequest, PagedLOD::Reading))
+        {
+            requestDiscarded(plod);
+            continue;
+        }
 
-                // std::cout<<"    finished reading "<<plod->filename<<", "<<plod->requestCount.load()<<std::endl;
+        uint32_t childIndex = plod->requestChild.load();
+        if (childIndex >= plod->getNumChildren() || plod->getChild(childIndex).filename.empty())
+        {
+            requestDiscarded(plod);
+            continue;
+        }
 
-                if (subgraph && compare_exchange(plod->requestStatus, PagedLOD::Reading, PagedLOD::CompileRequest))
-                {
-                    {
-                        //std::cout<<"   assigned subgraph to plod"<<std::endl;
-                        std::scoped_lock<std::mutex> lock(databasePager.pendingPagedLODMutex);
-                        plod->pending = subgraph;
-                    }
+        const auto& filename = plod->getChild(childIndex).filename;
 
-                    // move to the merge queue;
-                    compileQueue->add_then_reset(plod);
-                }
-                else
-                {
-                    databasePager.requestDiscarded(plod);
-                }
-            }
-        }
-        //std::cout<<"Finished DatabaseThread read thread"<<std::endl;
-    };
+        //std::cout<<"    reading "<<filename<<", "<<plod->requestCount.load()<<std::endl;
 
-    for (int i = 0; i < numReadThreads; ++i)
-    {
-        _readThreads.emplace_back(std::thread(read, std::ref(_requestQueue), std::ref(_compileQueue), std::ref(_active), std::ref(*this)));
-    }
+        auto before_read = clock::now();
 
-    //
-    // set up compile thread(s)
-    //
-    auto compile = [](ref_ptr<DatabaseQueue> compileQueue, ref_ptr<DatabaseQueue> toMergeQueue, ref_ptr<CompileTraversal> db_ct, ref_ptr<Active> a, DatabasePager& databasePager) {
-        //std::cout<<"Started DatabaseThread compile thread"<<std::endl;
+        auto subgraph = vsg::read_cast<vsg::Node>(filename, plod->options);
 
-        std::list<ref_ptr<CompileTraversal>> compileTraversals;
+        statistics->read.add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - before_read).count()));
 
-        int numCompileContexts = 16;
+        // std::cout<<"    finished reading "<<filename<<", "<<plod->requestCount.load()<<std::endl;
 
-        for (int i = 0; i < numCompileContexts; ++i)
+        // the size is only assigned to the PagedLOD along with the pending subgraph, as the request may yet be discarded
+        uint64_t cpuMemoryUsage = 0;
+        if (subgraph)
         {
-            compileTraversals.emplace_back(new CompileTraversal(*db_ct));
+            ComputeDataSize computeDataSize;
+            subgraph->accept(computeDataSize);
+            cpuMemoryUsage = computeDataSize.size;
+            statistics->numBytesRead += computeDataSize.size;
         }
 
-        // assign semaphores
-        for (auto& ct : compileTraversals)
+        // the PagedLOD may no longer be required by the time the read completes, so avoid passing it on to compile
+        if (subgraph && cancelStaleRequests && !plod->highResActive(frameCount))
         {
-            ct->context.semaphore = Semaphore::create(ct->context.device, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+            ++statistics->numReadsCancelled;
+            requestDiscarded(plod);
+            continue;
         }
 
-        auto compile_itr = compileTraversals.begin();
+        if (subgraph && compare_exchange(plod->requestStatus, PagedLOD::Reading, PagedLOD::CompileRequest))
+        {
+            {
+                //std::cout<<"   assigned subgraph to plod"<<std::endl;
+                std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
+                plod->pending = subgraph;
+                plod->pendingChild = childIndex;
+                plod->pendingCPUMemoryUsage = cpuMemoryUsage;
+            }
 
-        while (*(a))
+            // continue on to the compile stage
+            output.add_then_reset(plod);
+        }
+        else
         {
-            auto nodesToCompileOrDelete = compileQueue->take_all_when_available();
+            requestDiscarded(plod);
+        }
+    }
+}
 
-            DatabaseQueue::Nodes nodesToCompile;
-            for (auto& plod : nodesToCompileOrDelete)
-            {
-                if (compare_exchange(plod->requestStatus, PagedLOD::DeleteRequest, PagedLOD::Deleting))
-                {
+void DatabasePager::_compile(DatabaseQueue::Nodes& nodes, StageQueue<PagedLOD>& output)
+{
+    DatabaseQueue::Nodes nodesToCompile;
+    for (auto& plod : nodes)
+    {
+        if (compare_exchange(plod->requestStatus, PagedLOD::DeleteRequest, PagedLOD::Deleting))
+        {
 #if REPORT_STATS
-                    std::cout << "    from compile thread releasing subgraph for plod = " << plod << std::endl;
+            std::cout << "    from compile thread releasing subgraph for plod = " << plod << std::endl;
 #endif
-                    ref_ptr<Node> subgraph;
-                    {
-                        std::scoped_lock<std::mutex> lock(databasePager.pendingPagedLODMutex);
-                        subgraph = plod->pending;
-                        plod->pending = nullptr;
-                    }
+            ref_ptr<Node> subgraph;
+            {
+                std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
+                subgraph = plod->pending;
+                plod->pending = nullptr;
+            }
 
-                    //plod->requestStatus.exchange(PagedLOD::NoRequest);
-                    databasePager.requestDiscarded(plod);
-                }
-                else
+            auto expired = subgraph.cast<ExpiredSubgraphs>();
+            if (expired && subgraphCache)
+            {
+                auto& children = expired->getChildren();
+                for (size_t i = 0; i < children.size(); ++i)
                 {
-                    nodesToCompile.emplace_back(plod);
+                    if (expired->filenames[i].empty()) continue;
+
+                    ReleaseVulkanObjects releaseVulkanObjects;
+                    children[i]->accept(releaseVulkanObjects);
+
+                    ComputeDataSize computeDataSize;
+                    children[i]->accept(computeDataSize);
+
+                    subgraphCache->add(expired->filenames[i], children[i], computeDataSize.size);
                 }
             }
 
-            if (!nodesToCompile.empty())
+            // expired PagedLOD have no active request, other than one made whilst it was being deleted which request() couldn't queue
+            plod->requestTime = 0;
+            if (plod->requestCount.exchange(0) > 0) --numActiveRequests;
+            plod->requestStatus.exchange(PagedLOD::NoRequest);
+        }
+        else
+        {
+            nodesToCompile.emplace_back(plod);
+        }
+    }
+
+    if (nodesToCompile.empty()) return;
+
+    if (!compileTraversal)
+    {
+        // no compile stage so pass the subgraphs straight on to be merged
+        DatabaseQueue::Nodes nodesToMerge;
+        for (auto& plod : nodesToCompile)
+        {
+            if (compare_exchange(plod->requestStatus, PagedLOD::CompileRequest, PagedLOD::MergeRequest))
+            {
+                plod->pendingGPUMemoryUsage = 0;
+                nodesToMerge.emplace_back(plod);
+            }
+        }
+
+        if (!nodesToMerge.empty()) output.add(nodesToMerge);
+        return;
+    }
+
+#if DO_TIMING
+    auto before_take = clock::now();
+#endif
+    // take a CompileTraversal whose previous transfers have completed, blocking until the completion thread returns one
+    auto ct = _takeCompileTraversal();
+    if (!ct) return;
+
+#if DO_TIMING
+    std::cout << "Wait for available CompileTraversal : " << std::chrono::duration<double, std::chrono::milliseconds::period>(clock::now() - before_take).count() << "ms" << std::endl;
+#endif
+
+    // each dispatch signals a new semaphore so that the CompileTraversal can be reused as soon as its transfers complete,
+    // without waiting for the frame that waits on the semaphore to complete.
+    ct->context.semaphore = Semaphore::create(ct->context.device, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+    DatabaseQueue::Nodes nodesCompiled;
+    for (auto& plod : nodesToCompile)
+    {
+        if (compare_exchange(plod->requestStatus, PagedLOD::CompileRequest, PagedLOD::Compiling))
+        {
+            uint64_t frameDelta = frameCount - plod->frameHighResLastUsed.load();
+            if (frameDelta <= 1)
             {
-                CompileTraversal* ct = compile_itr->get();
+                // std::cout<<"    compiling "<<plod<<", "<<plod->requestCount.load()<<std::endl;
 
-                ++compile_itr;
-                // advance the compile iterator to the next CompileTraversal in the list, wrap around if we get to the end
-                if (compile_itr == compileTraversals.end())
+                ref_ptr<Node> subgraph;
                 {
-                    // std::cout<<"Wrapping around"<<std::endl;
-                    compile_itr = compileTraversals.begin();
+                    std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
+                    subgraph = plod->pending;
+                }
+
+                // compiling subgraph
+                if (subgraph)
+                {
+                    // the device memory reserved while compiling is the GPU memory footprint of the subgraph
+                    VkDeviceSize before_compile_deviceMemoryReserved = ct->context.deviceMemoryReserved;
+                    auto before_compile = clock::now();
+
+                    subgraph->accept(*ct);
+
+                    statistics->compile.add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - before_compile).count()));
+                    plod->pendingGPUMemoryUsage = ct->context.deviceMemoryReserved - before_compile_deviceMemoryReserved;
+                    nodesCompiled.emplace_back(plod);
                 }
                 else
                 {
-                    // std::cout<<"Using next CompileTraversal"<<std::endl;
+                    // need to reset the PLOD so that it's no longer part of the DatabasePager's queues and is ready to be compile when next requested.
+                    std::cout << "Expire compile request " << plod->getChild(plod->requestChild).filename << std::endl;
+                    requestDiscarded(plod);
                 }
-
+            }
+            else
+            {
 #if REPORT_STATS
-                //std::cout<<"Compile Semaphore before wait Semaphore "<<*(ct->context.semaphore->data())<<" , count "<<ct->context.semaphore->numDependentSubmissions().load()<<std::endl;
-                int64_t before_wait_memoryTotalAvailble = ct->context.stagingMemoryBufferPools->computeMemoryTotalAvailble();
-                int64_t before_wait_memoryTotalReserved = ct->context.stagingMemoryBufferPools->computeMemoryTotalReserved();
-                int64_t before_wait_bufferTotalAvailble = ct->context.stagingMemoryBufferPools->computeBufferTotalAvailble();
-                int64_t before_wait_bufferTotalReserved = ct->context.stagingMemoryBufferPools->computeBufferTotalReserved();
+                std::cout << "Expire compile request" << std::endl;
 #endif
+                // need to reset the PLOD so that it's no longer part of the DatabasePager's queues and is ready to be compile when next requested.
+                ++statistics->numCompileRequestsCancelled;
+                requestDiscarded(plod);
+            }
+        }
+        else
+        {
+            std::cout << "PagedLOD::requestStatus not DeleteRequest or CompileRequest so ignoring status = " << plod->requestStatus.load() << std::endl;
+        }
+    }
 
-#if DO_TIMING
-                auto before_wait_for_completion = clock::now();
-#endif
-                ct->context.waitForCompletion();
+    if (!nodesCompiled.empty())
+    {
+        ct->context.dispatch();
 
-#if REPORT_STATS
-                int64_t after_wait_memoryTotalAvailble = ct->context.stagingMemoryBufferPools->computeMemoryTotalAvailble();
-                int64_t after_wait_memoryTotalReserved = ct->context.stagingMemoryBufferPools->computeMemoryTotalReserved();
-                int64_t after_wait_bufferTotalAvailble = ct->context.stagingMemoryBufferPools->computeBufferTotalAvailble();
-                int64_t after_wait_bufferTotalReserved = ct->context.stagingMemoryBufferPools->computeBufferTotalReserved();
+        for (auto& plod : nodesCompiled)
+        {
+            plod->semaphore = ct->context.semaphore;
+            plod->requestStatus.exchange(PagedLOD::MergeRequest);
+        }
 
-                std::cout << "waitForComplete() A before_wait_memoryTotalAvailble = " << before_wait_memoryTotalAvailble << ", after_wait_memoryTotalAvailble = " << after_wait_memoryTotalAvailble << std::endl;
-                std::cout << "waitForComplete() A before_wait_memoryTotalReserved = " << before_wait_memoryTotalReserved << ", after_wait_memoryTotalReserved = " << after_wait_memoryTotalReserved << std::endl;
-                std::cout << "waitForComplete() A before_wait_bufferTotalAvailble = " << before_wait_bufferTotalAvailble << ", after_wait_bufferTotalAvailble = " << after_wait_bufferTotalAvailble << ", delta = " << (after_wait_bufferTotalAvailble - before_wait_bufferTotalAvailble) << std::endl;
-                std::cout << "waitForComplete() A before_wait_bufferTotalReserved = " << before_wait_bufferTotalReserved << ", after_wait_bufferTotalReserved = " << after_wait_bufferTotalReserved << ", delta = " << (after_wait_bufferTotalReserved - before_wait_bufferTotalReserved) << std::endl;
+        output.add(nodesCompiled);
 
-                //std::cout<<"Compile Semaphore after wait Semaphore "<<*(ct->context.semaphore->data())<<" , count "<<ct->context.semaphore->numDependentSubmissions().load()<<std::endl;
-#endif
+        // pass on to the completion thread to wait for the transfers to complete before the CompileTraversal is reused
+        _compileTraversalDispatched(ct);
+    }
+    else
+    {
+        ct->context.semaphore = nullptr;
+        _releaseCompileTraversal(ct);
+    }
+}
+
+void DatabasePager::_setNumCompileThreads(uint32_t numThreads)
+{
+    // each compile thread adds its share of CompileTraversal to the pool that all the compile threads take from
+    uint32_t numStarted = _compileStage->getNumThreads();
+    if (compileTraversal && numThreads > numStarted)
+    {
+        uint32_t numContexts = std::max(numCompileContexts, 1u) * (numThreads - numStarted);
+        for (uint32_t i = 0; i < numContexts; ++i)
+        {
+            _releaseCompileTraversal(ref_ptr<CompileTraversal>(new CompileTraversal(*compileTraversal)));
+        }
 
-                while (ct->context.semaphore->numDependentSubmissions().load() > 0)
+        if (!_completionThread.joinable())
+        {
+            auto completion = [](ref_ptr<Active> a, DatabasePager& databasePager) {
+                setThreadPriority(databasePager.compileThreadPriority);
+
+                while (*(a))
                 {
-                    if (!(*(a))) return;
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    auto ct = databasePager._takeDispatchedCompileTraversal();
+                    if (!ct) continue;
+
+                    // wait on the fence associated with the CompileTraversal's last dispatch, then return it to the pool
+                    ct->context.waitForCompletion();
+                    databasePager._releaseCompileTraversal(ct);
                 }
+            };
 
-#if DO_TIMING
-                auto after_wait_and_semaphore = clock::now();
-                static double total_wait_time = 0.0;
-                static double num_waits = 0.0;
-                total_wait_time += std::chrono::duration<double, std::chrono::milliseconds::period>(after_wait_and_semaphore - before_wait_for_completion).count();
-                num_waits += 1.0;
+            _completionThread = std::thread(completion, std::ref(_active), std::ref(*this));
+            if (compileAffinity) setAffinity(_completionThread, compileAffinity);
+        }
+    }
 
-                std::cout << "Fence + Semaphore wait : " << std::chrono::duration<double, std::chrono::milliseconds::period>(after_wait_and_semaphore - before_wait_for_completion).count() << " average = " << (total_wait_time / num_waits) << std::endl;
-#endif
+    _compileStage->setConcurrencyLimit(numThreads);
+}
 
-                ct->context.semaphore->numDependentSubmissions().exchange(1);
+ref_ptr<CompileTraversal> DatabasePager::_takeCompileTraversal()
+{
+    std::chrono::duration waitDuration = std::chrono::milliseconds(100);
+    std::unique_lock lock(_compileTraversalMutex);
 
-                DatabaseQueue::Nodes nodesCompiled;
-                for (auto& plod : nodesToCompile)
-                {
-                    if (compare_exchange(plod->requestStatus, PagedLOD::CompileRequest, PagedLOD::Compiling))
-                    {
-                        uint64_t frameDelta = databasePager.frameCount - plod->frameHighResLastUsed.load();
-                        if (frameDelta <= 1)
-                        {
-                            // std::cout<<"    compiling "<<plod->filename<<", "<<plod->requestCount.load()<<" Semaphore "<<*(ct->context.semaphore->data())<<", count "<<ct->context.semaphore->numDependentSubmissions().load()<<std::endl;
+    while (_availableCompileTraversals.empty() && *_active)
+    {
+        _compileTraversalAvailable.wait_for(lock, waitDuration);
+    }
 
-                            ref_ptr<Node> subgraph;
-                            {
-                                std::scoped_lock<std::mutex> lock(databasePager.pendingPagedLODMutex);
-                                subgraph = plod->pending;
-                            }
+    if (_availableCompileTraversals.empty() || !(*_active)) return {};
 
-                            // compiling subgraph
-                            if (subgraph)
-                            {
-                                subgraph->accept(*ct);
-                                nodesCompiled.emplace_back(plod);
-                            }
-                            else
-                            {
-                                // need to reset the PLOD so that it's no longer part of the DatabasePager's queues and is ready to be compile when next requested.
-                                std::cout << "Expire compile request " << plod->filename << std::endl;
-                                databasePager.requestDiscarded(plod);
-                            }
-                        }
-                        else
-                        {
-#if 0
-                            {
-                                std::scoped_lock<std::mutex> lock(databasePager.pendingPagedLODMutex);
-                                plod->pending = nullptr;
-                            }
-#endif
-#if REPORT_STATS
-                            std::cout << "Expire compile request" << std::endl;
-#endif
-                            // need to reset the PLOD so that it's no longer part of the DatabasePager's queues and is ready to be compile when next requested.
-                            databasePager.requestDiscarded(plod);
-                        }
-                    }
-                    else
-                    {
-                        std::cout << "PagedLOD::requestStatus not DeleteRequest or CompileRequest so ignoring status = " << plod->requestStatus.load() << std::endl;
-                    }
-                }
+    auto ct = _availableCompileTraversals.front();
+    _availableCompileTraversals.pop_front();
+    return ct;
+}
 
-#if REPORT_STATS
-                int64_t after_complile_traversal_memoryTotalAvailble = ct->context.stagingMemoryBufferPools->computeMemoryTotalAvailble();
-                int64_t after_complile_traversal_memoryTotalReserved = ct->context.stagingMemoryBufferPools->computeMemoryTotalReserved();
-                int64_t after_complile_traversal_bufferTotalAvailble = ct->context.stagingMemoryBufferPools->computeBufferTotalAvailble();
-                int64_t after_complile_traversal_bufferTotalReserved = ct->context.stagingMemoryBufferPools->computeBufferTotalReserved();
-
-                std::cout << "waitForComplete() B after_wait_memoryTotalAvailble = " << after_wait_memoryTotalAvailble << ", after_complile_traversal_memoryTotalAvailble = " << after_complile_traversal_memoryTotalAvailble << std::endl;
-                std::cout << "waitForComplete() B after_wait_memoryTotalReserved = " << after_wait_memoryTotalReserved << ", after_complile_traversal_memoryTotalReserved = " << after_complile_traversal_memoryTotalReserved << std::endl;
-                std::cout << "waitForComplete() B after_wait_bufferTotalAvailble = " << after_wait_bufferTotalAvailble << ", after_complile_traversal_bufferTotalAvailble = " << after_complile_traversal_bufferTotalAvailble << " delta = " << (after_complile_traversal_bufferTotalAvailble - after_wait_bufferTotalAvailble) << std::endl;
-                std::cout << "waitForComplete() B after_wait_bufferTotalReserved = " << after_wait_bufferTotalReserved << ", after_complile_traversal_bufferTotalReserved = " << after_complile_traversal_bufferTotalReserved << " delta = " << (after_complile_traversal_bufferTotalReserved - after_wait_bufferTotalReserved) << std::endl;
-#endif
-                if (!nodesCompiled.empty())
-                {
-                    ct->context.dispatch();
+void DatabasePager::_releaseCompileTraversal(ref_ptr<CompileTraversal> ct)
+{
+    std::scoped_lock lock(_compileTraversalMutex);
+    _availableCompileTraversals.push_back(ct);
+    _compileTraversalAvailable.notify_one();
+}
 
-                    for (auto& plod : nodesCompiled)
-                    {
-                        plod->semaphore = ct->context.semaphore;
-                        plod->requestStatus.exchange(PagedLOD::MergeRequest);
-                    }
+void DatabasePager::_compileTraversalDispatched(ref_ptr<CompileTraversal> ct)
+{
+    std::scoped_lock lock(_compileTraversalMutex);
+    _dispatchedCompileTraversals.push_back(ct);
+    _compileTraversalDispatchedCondition.notify_one();
+}
 
-                    toMergeQueue->add(nodesCompiled);
-                }
-                else
-                {
-                    ct->context.semaphore->numDependentSubmissions().exchange(0);
-                }
-            }
+ref_ptr<CompileTraversal> DatabasePager::_takeDispatchedCompileTraversal()
+{
+    std::chrono::duration waitDuration = std::chrono::milliseconds(100);
+    std::unique_lock lock(_compileTraversalMutex);
+
+    while (_dispatchedCompileTraversals.empty() && *_active)
+    {
+        _compileTraversalDispatchedCondition.wait_for(lock, waitDuration);
+    }
+
+    if (_dispatchedCompileTraversals.empty()) return {};
+
+    // submissions to the same queue complete in order, so wait on them in the order they were dispatched
+    auto ct = _dispatchedCompileTraversals.front();
+    _dispatchedCompileTraversals.pop_front();
+    return ct;
+}
+
+void DatabasePager::adaptThreads()
+{
+    // read threads are I/O bound, so estimate how long the queued reads will take to drain with the current number of threads
+    // and add threads while that is longer than the target time, retiring them again once the queue has remained empty for a while.
+    uint64_t readDuration = statistics->read.total.load();
+    uint64_t numReads = statistics->read.count.load();
+    if (numReads > _previousNumReads)
+    {
+        double averageReadTime = double(readDuration - _previousReadDuration) * 1e-6 / double(numReads - _previousNumReads);
+        _averageReadTime = (_averageReadTime > 0.0) ? (_averageReadTime * 0.9 + averageReadTime * 0.1) : averageReadTime;
+    }
+    _previousReadDuration = readDuration;
+    _previousNumReads = numReads;
+
+    size_t readQueueDepth = _requestQueue->size();
+    uint32_t minReadThreads = std::max(numReadThreads, 1u);
+    uint32_t maxReadThreads = std::max(maxNumReadThreads, minReadThreads);
+    uint32_t targetReadThreads = _readStage->getConcurrencyLimit();
+
+    double estimatedDrainTime = _averageReadTime * double(readQueueDepth) / double(targetReadThreads);
+    if (estimatedDrainTime > targetReadQueueDrainTime && targetReadThreads < maxReadThreads)
+    {
+        ++targetReadThreads;
+        _numFramesReadQueueEmpty = 0;
+    }
+    else if (readQueueDepth == 0 && targetReadThreads > minReadThreads)
+    {
+        if (++_numFramesReadQueueEmpty >= numFramesBeforeRetiringThread)
+        {
+            --targetReadThreads;
+            _numFramesReadQueueEmpty = 0;
         }
-        //std::cout<<"Finished DatabaseThread compile thread"<<std::endl;
-    };
+    }
+    else
+    {
+        _numFramesReadQueueEmpty = 0;
+    }
+
+    _readStage->setConcurrencyLimit(targetReadThreads);
 
-    for (int i = 0; i < numCompileThreads; ++i)
+    // compile threads are scaled with the backlog of PagedLOD waiting to be compiled.
+    size_t compileBacklog = _compileQueue->size();
+    uint32_t minCompileThreads = std::max(numCompileThreads, 1u);
+    uint32_t maxCompileThreads = std::max(maxNumCompileThreads, minCompileThreads);
+    uint32_t targetCompileThreads = _compileStage->getConcurrencyLimit();
+
+    if (compileBacklog > (targetCompileBacklogPerThread * targetCompileThreads) && targetCompileThreads < maxCompileThreads)
+    {
+        ++targetCompileThreads;
+        _numFramesCompileQueueEmpty = 0;
+    }
+    else if (compileBacklog == 0 && targetCompileThreads > minCompileThreads)
     {
-        _compileThreads.emplace_back(std::thread(compile, std::ref(_compileQueue), std::ref(_toMergeQueue), std::ref(compileTraversal), std::ref(_active), std::ref(*this)));
+        if (++_numFramesCompileQueueEmpty >= numFramesBeforeRetiringThread)
+        {
+            --targetCompileThreads;
+            _numFramesCompileQueueEmpty = 0;
+        }
     }
+    else
+    {
+        _numFramesCompileQueueEmpty = 0;
+    }
+
+    _setNumCompileThreads(targetCompileThreads);
 }
 
 void DatabasePager::request(ref_ptr<PagedLOD> plod)
@@ -429,10 +791,11 @@ void DatabasePager::request(ref_ptr<PagedLOD> plod)
     ++numActiveRequests;
 
     //std::cout<<"DatabasePager::request("<<plod.get()<<") "<<plod->filename<<", "<<plod->priority<<std::endl;
+    // a pending subgraph can only be used if it was loaded for the child now being requested
     bool hasPending = false;
     {
         std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
-        hasPending = plod->pending.valid();
+        hasPending = plod->pending.valid() && plod->pendingChild == plod->requestChild.load();
     }
 
     if (hasPending)
@@ -440,6 +803,8 @@ void DatabasePager::request(ref_ptr<PagedLOD> plod)
         // std::cout<<"DatabasePager::request("<<plod.get()<<") has pending subgraphs to transfer to compile "<<plod->filename<<", "<<plod->priority<<" plod="<<plod.get()<<std::endl;
         if (compare_exchange(plod->requestStatus, PagedLOD::NoRequest, PagedLOD::CompileRequest))
         {
+            plod->requestTime = clock::now().time_since_epoch().count();
+            ++statistics->numRequests;
             _compileQueue->add(plod);
         }
         else
@@ -451,6 +816,11 @@ void DatabasePager::request(ref_ptr<PagedLOD> plod)
     {
         if (compare_exchange(plod->requestStatus, PagedLOD::NoRequest, PagedLOD::ReadRequest))
         {
+            plod->requestTime = clock::now().time_since_epoch().count();
+            ++statistics->numRequests;
+
+            if (subgraphCache && _requestFromCache(plod)) return;
+
             // std::cout<<"DatabasePager::request("<<plod.get()<<") adding to requeQueue "<<plod->filename<<", "<<plod->priority<<" plod="<<plod.get()<<std::endl;
             _requestQueue->add(plod);
         }
@@ -461,27 +831,128 @@ void DatabasePager::request(ref_ptr<PagedLOD> plod)
     }
 }
 
+bool DatabasePager::_requestFromCache(PagedLOD* plod)
+{
+    uint32_t childIndex = plod->requestChild.load();
+    if (childIndex >= plod->getNumChildren()) return false;
+
+    bool pendingRequested = false;
+    {
+        // the pending subgraph is kept after it's been merged as the pendingChild, so replacing it then only releases a reference. One that hasn't been
+        // merged is compiled as is if it was loaded for the requested child, otherwise it's left in place as deleting it here would stall the calling thread.
+        std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
+        if (plod->pending)
+        {
+            bool merged = plod->pendingChild < plod->getNumChildren() && plod->getChild(plod->pendingChild).node == plod->pending;
+            if (!merged)
+            {
+                if (plod->pendingChild != childIndex) return false;
+                pendingRequested = true;
+            }
+        }
+    }
+
+    if (pendingRequested)
+    {
+        plod->requestStatus.exchange(PagedLOD::CompileRequest);
+        _compileQueue->add(ref_ptr<PagedLOD>(plod));
+        return true;
+    }
+
+    uint64_t size = 0;
+    auto subgraph = subgraphCache->take(plod->getChild(childIndex).filename, size);
+    if (!subgraph) return false;
+
+    {
+        std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
+        plod->pending = subgraph;
+        plod->pendingChild = childIndex;
+        plod->pendingCPUMemoryUsage = size;
+    }
+
+    // the PagedLOD hasn't been added to the read queue yet, so no other thread can be changing its requestStatus
+    plod->requestStatus.exchange(PagedLOD::CompileRequest);
+    ++statistics->numCacheHits;
+
+    _compileQueue->add(ref_ptr<PagedLOD>(plod));
+    return true;
+}
+
 void DatabasePager::requestDiscarded(PagedLOD* plod)
 {
     //std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
     //plod->pending = nullptr;
+    plod->requestTime = 0;
     plod->requestCount.exchange(0);
     plod->requestStatus.exchange(PagedLOD::NoRequest);
     --numActiveRequests;
+    ++statistics->numDiscarded;
+}
+
+void DatabasePager::cancelRequests()
+{
+    uint64_t fc = frameCount.load();
+
+    // PagedLOD waiting to be read that haven't been required in the last frame.
+    auto readRequests = _requestQueue->take_if([fc](const PagedLOD* plod) {
+        return !plod->highResActive(fc);
+    });
+
+    for (auto& plod : readRequests)
+    {
+        requestDiscarded(plod);
+    }
+    statistics->numReadRequestsCancelled += readRequests.size();
+
+    // PagedLOD waiting to be compiled that haven't been required in the last frame, DeleteRequest entries are left for the compile thread to handle.
+    // The pending subgraph is retained so that a subsequent request can go straight to compile.
+    auto compileRequests = _compileQueue->take_if([fc](const PagedLOD* plod) {
+        return plod->requestStatus.load() == PagedLOD::CompileRequest && !plod->highResActive(fc);
+    });
+
+    for (auto& plod : compileRequests)
+    {
+        requestDiscarded(plod);
+    }
+    statistics->numCompileRequestsCancelled += compileRequests.size();
 }
 
 void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
 {
+    auto start_update = clock::now();
+
     frameCount.exchange(frameStamp ? frameStamp->frameCount : 0);
 
     _semaphores.clear();
 
-    auto nodes = _toMergeQueue->take_all();
+    if (cancelStaleRequests)
+    {
+        cancelRequests();
+    }
+
+    if (adaptiveThreading && _readStage->getNumThreads() > 0)
+    {
+        adaptThreads();
+    }
+
+    // take the compiled subgraphs to merge this frame, highest priority first when merging is budgeted
+    DatabaseQueue::Nodes nodes;
+    if (maxNumMergesPerFrame > 0 || mergeTimeBudget > 0.0)
+    {
+        nodes = _toMergeQueue->take((maxNumMergesPerFrame > 0) ? maxNumMergesPerFrame : std::numeric_limits<size_t>::max());
+    }
+    else
+    {
+        nodes = _toMergeQueue->take_all();
+    }
+
+    size_t numReadyToMerge = nodes.size() + _toMergeQueue->size();
 
     if (culledPagedLODs)
     {
+        auto start_bookkeeping = clock::now();
 #if DO_TIMING
-        auto start_tick = clock::now();
+        auto start_tick = start_bookkeeping;
 #endif
         auto previous_activeList_count = pagedLODContainer->activeList.count;
         auto& elements = pagedLODContainer->elements;
@@ -526,19 +997,28 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
             }
         }
 
+        // newly required and refreshed PagedLOD are moved to the tail of the activeList, keeping it ordered by frameActiveRefreshed
+        for (auto& plod : culledPagedLODs->newHighresRequired)
+        {
+            pagedLODContainer->active(plod);
+        }
+
+        // PagedLOD in continuous use are refreshed every activeRefreshInterval frames, so any at the head of the activeList that haven't been refreshed
+        // for longer than that are no longer in use. This keeps the cost proportional to the number of PagedLOD changing state rather than the number resident.
         auto& activeList = pagedLODContainer->activeList;
+        auto activeRefreshInterval = culledPagedLODs->activeRefreshInterval;
         uint32_t switchedCount = 0;
-        for (uint32_t index = activeList.head; index != 0;)
+        while (activeList.head != 0)
         {
-            auto& element = elements[index];
-            index = element.next;
+            auto& element = elements[activeList.head];
+            if ((frameCount - element.plod->frameActiveRefreshed.load()) <= activeRefreshInterval) break;
 
-            if (!element.plod->highResActive(frameCount))
-            {
-                //std::cout<<"   active to inactive "<<index<<std::endl;
-                ++switchedCount;
-                pagedLODContainer->inactive(element.plod.get());
-            }
+            // only possible if activeRefreshInterval has been reduced, leave it to be refreshed on its next use
+            if (element.plod->highResActive(frameCount)) break;
+
+            //std::cout<<"   active to inactive "<<activeList.head<<std::endl;
+            ++switchedCount;
+            pagedLODContainer->inactive(element.plod.get());
         }
 
 #    if REPORT_STATS
@@ -554,13 +1034,6 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
         auto after_inactive_tick = clock::now();
 #endif
 
-        //std::cout<<"  newly active nodes:"<<std::endl;
-
-        for (auto& plod : culledPagedLODs->newHighresRequired)
-        {
-            pagedLODContainer->active(plod);
-        }
-
         auto after_activeList_count = pagedLODContainer->activeList.count;
 
         if (after_activeList_count > previous_activeList_count)
@@ -572,30 +1045,95 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
         auto after_active_tick = clock::now();
 #endif
 
+        // reposition any pending read requests whose priority has been raised by the last RecordTraversal
+        _requestQueue->updatePriorities(culledPagedLODs->priorityIncreased);
+
         culledPagedLODs->clear();
 
-        // set the number of PagedLOD to expire
-        uint32_t total = pagedLODContainer->activeList.count + pagedLODContainer->inactiveList.count;
-        if ((nodes.size() + total) > targetMaxNumPagedLODWithHighResSubgraphs)
+        // memory required once the subgraphs waiting to be merged have been merged
+        uint64_t cpuMemoryRequired = _cpuMemoryUsage;
+        uint64_t gpuMemoryRequired = _gpuMemoryUsage;
+        for (auto& plod : nodes)
         {
-            uint32_t numPagedLODHighRestSubgraphsToRemove = (static_cast<uint32_t>(nodes.size()) + total) - targetMaxNumPagedLODWithHighResSubgraphs;
-            uint32_t targetNumInactive = (numPagedLODHighRestSubgraphsToRemove < pagedLODContainer->inactiveList.count) ? (pagedLODContainer->inactiveList.count - numPagedLODHighRestSubgraphsToRemove) : 0;
+            cpuMemoryRequired += plod->pendingCPUMemoryUsage;
+            gpuMemoryRequired += plod->pendingGPUMemoryUsage;
+        }
 
-            // std::cout<<"Need to remove, inactive count = "<<pagedLODContainer->inactiveList.count <<", target = "<< targetNumInactive<<std::endl;
+        uint32_t numToMerge = static_cast<uint32_t>(nodes.size());
+        auto exceedsTargets = [&]() {
+            uint32_t total = numToMerge + pagedLODContainer->activeList.count + pagedLODContainer->inactiveList.count;
+            return (total > targetMaxNumPagedLODWithHighResSubgraphs) ||
+                   (cpuMemoryBudget > 0 && cpuMemoryRequired > cpuMemoryBudget) ||
+                   (gpuMemoryBudget > 0 && gpuMemoryRequired > gpuMemoryBudget);
+        };
 
-            for (uint32_t index = pagedLODContainer->inactiveList.head; (index != 0) && (pagedLODContainer->inactiveList.count > targetNumInactive);)
+        // expire inactive PagedLOD, starting with the least recently used at the head of the inactiveList, until the count and memory targets are met
+        for (uint32_t index = pagedLODContainer->inactiveList.head; (index != 0) && exceedsTargets();)
+        {
+            auto& element = elements[index];
+            index = element.next;
+
+            if (compare_exchange(element.plod->requestStatus, PagedLOD::NoRequest, PagedLOD::DeleteRequest))
             {
-                auto& element = elements[index];
-                index = element.next;
+                // std::cout<<"    trimming "<<plod<<std::endl;
+                ref_ptr<PagedLOD> plod = element.plod;
+
+                cpuMemoryRequired -= plod->cpuMemoryUsage;
+                gpuMemoryRequired -= plod->gpuMemoryUsage;
+                _cpuMemoryUsage -= plod->cpuMemoryUsage;
+                _gpuMemoryUsage -= plod->gpuMemoryUsage;
+                plod->cpuMemoryUsage = 0;
+                plod->gpuMemoryUsage = 0;
+
+                // detach the external children, passing any that aren't the pending subgraph to the compile thread along with it so that they are deleted there
+                if (subgraphCache)
+                {
+                    // pass all the loaded subgraphs to the compile thread with their filenames so that they can be moved into the subgraphCache
+                    std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
+                    auto expired = ExpiredSubgraphs::create();
+                    bool pendingExpired = false;
+                    for (auto& child : plod->getChildren())
+                    {
+                        if (child.filename.empty() || !child.node) continue;
 
-                if (compare_exchange(element.plod->requestStatus, PagedLOD::NoRequest, PagedLOD::DeleteRequest))
+                        if (child.node == plod->pending) pendingExpired = true;
+                        expired->add(child.filename, child.node);
+                        child.node = nullptr;
+                    }
+                    if (plod->pending && !pendingExpired)
+                    {
+                        Path filename;
+                        if (plod->pendingChild < plod->getNumChildren()) filename = plod->getChild(plod->pendingChild).filename;
+                        expired->add(filename, plod->pending);
+                    }
+                    plod->pending = expired;
+                }
+                else
                 {
-                    // std::cout<<"    trimming "<<plod<<std::endl;
-                    ref_ptr<PagedLOD> plod = element.plod;
-                    plod->getChild(0).node = nullptr;
-                    pagedLODContainer->remove(plod);
-                    _compileQueue->add_then_reset(plod);
+                    std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
+                    ref_ptr<Group> released;
+                    for (auto& child : plod->getChildren())
+                    {
+                        if (child.filename.empty() || !child.node) continue;
+
+                        if (child.node != plod->pending)
+                        {
+                            if (!released)
+                            {
+                                released = Group::create();
+                                if (plod->pending) released->addChild(plod->pending);
+                            }
+                            released->addChild(child.node);
+                        }
+                        child.node = nullptr;
+                    }
+                    if (released) plod->pending = released;
                 }
+
+                pagedLODContainer->remove(plod);
+                _compileQueue->add_then_reset(plod);
+
+                ++statistics->numExpired;
             }
         }
 
@@ -614,6 +1152,8 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
         // if (numOrhphanedPagedLOD!=0)  std::cout<<"Found PagdLOD in pagedLODContainer without external references "<<numOrhphanedPagedLOD<<std::endl;
 #endif
 
+        statistics->update.add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start_bookkeeping).count()));
+
 #if DO_TIMING
         auto end_tick = clock::now();
         std::cout << "Time to check for inactive = " << std::chrono::duration<double, std::chrono::milliseconds::period>(after_inactive_tick - start_tick).count() << " active = " << std::chrono::duration<double, std::chrono::milliseconds::period>(after_active_tick - after_inactive_tick).count() << " merge = " << std::chrono::duration<double, std::chrono::milliseconds::period>(end_tick - after_active_tick).count() << "   effective fps = " << (1.0 / std::chrono::duration<double, std::chrono::seconds::period>(end_tick - after_active_tick).count()) << std::endl;
@@ -630,8 +1170,18 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
 #endif
 
         //std::cout<<"DatabasePager::updateSceneGraph() nodes to merge : nodes.size() = "<<nodes.size()<<", "<<numActiveRequests.load()<<std::endl;
+        auto before_merge = clock::now();
+        size_t numProcessed = 0;
         for (auto& plod : nodes)
         {
+            // once the time budget has been used defer the remaining merges, at least one merge is done each frame to guarantee progress
+            if (mergeTimeBudget > 0.0 && numProcessed > 0 && std::chrono::duration<double, std::chrono::seconds::period>(clock::now() - start_update).count() > mergeTimeBudget)
+            {
+                break;
+            }
+
+            ++numProcessed;
+
             if (compare_exchange(plod->requestStatus, PagedLOD::MergeRequest, PagedLOD::Merging))
             {
 #if DO_TIMING
@@ -651,9 +1201,21 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
 #if LOCAL_MUTEX
                     std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
 #endif
-                    plod->getChild(0).node = plod->pending;
+                    plod->getChild(plod->pendingChild).node = plod->pending;
                 }
 
+                plod->cpuMemoryUsage += plod->pendingCPUMemoryUsage;
+                plod->gpuMemoryUsage += plod->pendingGPUMemoryUsage;
+                _cpuMemoryUsage += plod->pendingCPUMemoryUsage;
+                _gpuMemoryUsage += plod->pendingGPUMemoryUsage;
+
+                ++statistics->numMerged;
+                statistics->requestToMergeLatency.add(std::chrono::duration<double, std::chrono::milliseconds::period>(before_merge - time_point(clock::duration(plod->requestTime.load()))).count());
+
+                // allow further requests for the PagedLOD's other external children, requestTime is cleared first so they never see this request's time
+                plod->requestTime = 0;
+                plod->requestCount.exchange(0);
+
                 // insert any semaphore into a set that will be used by the GraphicsStage
                 if (plod->semaphore)
                 {
@@ -664,10 +1226,45 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
                 plod->requestStatus.exchange(PagedLOD::NoRequest);
             }
         }
-        numActiveRequests -= static_cast<uint32_t>(nodes.size());
+        numActiveRequests -= static_cast<uint32_t>(numProcessed);
+
+        // return the merges that didn't fit in the time budget to the merge queue
+        if (numProcessed < nodes.size())
+        {
+            DatabaseQueue::Nodes deferred(nodes.begin() + numProcessed, nodes.end());
+            _toMergeQueue->add(deferred);
+        }
+
+        _numMerged = static_cast<uint32_t>(numProcessed);
+
+        statistics->merge.add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - before_merge).count()));
     }
     else
     {
         //std::cout<<"DatabasePager::updateSceneGraph() nothing to merge"<<std::endl;
+        _numMerged = 0;
     }
+
+    _numMergesDeferred = static_cast<uint32_t>(numReadyToMerge - _numMerged);
+
+    // sample the per frame statistics
+    statistics->frameCount = frameCount.load();
+    statistics->readQueueDepth = static_cast<uint32_t>(_requestQueue->size());
+    statistics->compileQueueDepth = static_cast<uint32_t>(_compileQueue->size());
+    statistics->mergeQueueDepth = static_cast<uint32_t>(_toMergeQueue->size());
+    statistics->numActiveRequests = numActiveRequests.load();
+    statistics->activeListSize = pagedLODContainer->activeList.count;
+    statistics->inactiveListSize = pagedLODContainer->inactiveList.count;
+    statistics->numMergedLastFrame = _numMerged;
+    statistics->numMergesDeferredLastFrame = _numMergesDeferred;
+    statistics->cpuMemoryUsage = _cpuMemoryUsage;
+    statistics->gpuMemoryUsage = _gpuMemoryUsage;
+    statistics->cacheMemoryUsage = subgraphCache ? subgraphCache->getMemoryUsage() : 0;
+
+#if REPORT_STATS
+    if (_numMergesDeferred > 0)
+    {
+        std::cout << "DatabasePager::updateSceneGraph() merged " << _numMerged << ", deferred " << _numMergesDeferred << std::endl;
+    }
+#endif
 }
@@ -19,6 +19,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/core/Objects.h>
 #include <vsg/core/Value.h>
 
+#include <vsg/nodes/BatchCullGroup.h>
 #include <vsg/nodes/Commands.h>
 #include <vsg/nodes/CullGroup.h>
 #include <vsg/nodes/CullNode.h>
@@ -172,6 +173,7 @@ ObjectFactory::ObjectFactory()
     VSG_REGISTER_create(vsg::StateGroup);
     VSG_REGISTER_create(vsg::CullGroup);
     VSG_REGISTER_create(vsg::CullNode);
+    VSG_REGISTER_create(vsg::BatchCullGroup);
     VSG_REGISTER_create(vsg::LOD);
     VSG_REGISTER_create(vsg::PagedLOD);
     VSG_REGISTER_create(vsg::MatrixTransform);
@@ -19,6 +19,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <cstring>
 #include <iostream>
+#include <sstream>
 
 using namespace vsg;
 
@@ -31,6 +32,12 @@ ReaderWriter_vsg::ReaderWriter_vsg()
 }
 
 ReaderWriter_vsg::FormatType ReaderWriter_vsg::readHeader(std::istream& fin) const
+{
+    VsgVersion version;
+    return readHeader(fin, version);
+}
+
+ReaderWriter_vsg::FormatType ReaderWriter_vsg::readHeader(std::istream& fin, VsgVersion& version) const
 {
     fin.imbue(s_class_locale);
 
@@ -56,6 +63,20 @@ ReaderWriter_vsg::FormatType ReaderWriter_vsg::readHeader(std::istream& fin) con
     fin.getline(read_line, sizeof(read_line) - 1);
     //std::cout << "First line [" << read_line << "]" << std::endl;
 
+    // the rest of the line is the version of the VSG library that wrote the file
+    std::istringstream str(read_line);
+    str.imbue(s_class_locale);
+    char dot1 = 0, dot2 = 0;
+    VsgVersion fileVersion;
+    if (str >> fileVersion.majorVersion >> dot1 >> fileVersion.minorVersion >> dot2 >> fileVersion.patchVersion && dot1 == '.' && dot2 == '.')
+    {
+        version = fileVersion;
+    }
+    else
+    {
+        std::cout << "Header version not recognized [" << read_line << "]" << std::endl;
+    }
+
     return type;
 }
 
@@ -83,17 +104,20 @@ vsg::ref_ptr<vsg::Object> ReaderWriter_vsg::read(const vsg::Path& filename, ref_
         std::ifstream fin(filenameToUse, std::ios::in | std::ios::binary);
         if (!fin) return {};
 
-        FormatType type = readHeader(fin);
+        VsgVersion version;
+        FormatType type = readHeader(fin, version);
         if (type == BINARY)
         {
             vsg::BinaryInput input(fin, _objectFactory, options);
             input.filename = filenameToUse;
+            input.version = version;
             return input.readObject("Root");
         }
         else if (type == ASCII)
         {
             vsg::AsciiInput input(fin, _objectFactory, options);
             input.filename = filenameToUse;
+            input.version = version;
             return input.readObject("Root");
         }
     }
@@ -104,15 +128,18 @@ vsg::ref_ptr<vsg::Object> ReaderWriter_vsg::read(const vsg::Path& filename, ref_
 
 vsg::ref_ptr<vsg::Object> ReaderWriter_vsg::read(std::istream& fin, vsg::ref_ptr<const vsg::Options> options) const
 {
-    FormatType type = readHeader(fin);
+    VsgVersion version;
+    FormatType type = readHeader(fin, version);
     if (type == BINARY)
     {
         vsg::BinaryInput input(fin, _objectFactory, options);
+        input.version = version;
         return input.readObject("Root");
     }
     else if (type == ASCII)
     {
         vsg::AsciiInput input(fin, _objectFactory, options);
+        input.version = version;
         return input.readObject("Root");
     }
 
@@ -0,0 +1,114 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/maths/batchIntersect.h>
+
+#if defined(__AVX__)
+#    include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define VSG_BATCH_INTERSECT_SSE2
+#    include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#    define VSG_BATCH_INTERSECT_NEON
+#    include <arm_neon.h>
+#endif
+
+using namespace vsg;
+
+uint32_t vsg::intersect(const dplane* planes, uint32_t numPlanes, const double* x, const double* y, const double* z, const double* radius, uint32_t count, uint32_t* visible)
+{
+    uint32_t numVisible = 0;
+    uint32_t i = 0;
+
+    // the SIMD paths compute the signed distance of each sphere center from each plane, a sphere is outside if any distance is less than -radius,
+    // the lanes that are outside are accumulated as a bit mask so that the plane loop can exit as soon as all the spheres in the batch are outside.
+#if defined(__AVX__)
+    const int allOutside = 0xf;
+    for (; (i + 4) <= count; i += 4)
+    {
+        __m256d cx = _mm256_loadu_pd(x + i);
+        __m256d cy = _mm256_loadu_pd(y + i);
+        __m256d cz = _mm256_loadu_pd(z + i);
+        __m256d negative_radius = _mm256_sub_pd(_mm256_setzero_pd(), _mm256_loadu_pd(radius + i));
+
+        int outside = 0;
+        for (uint32_t p = 0; p < numPlanes && outside != allOutside; ++p)
+        {
+            const double* pl = planes[p].value;
+            __m256d d = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_broadcast_sd(pl), cx), _mm256_mul_pd(_mm256_broadcast_sd(pl + 1), cy)),
+                                      _mm256_add_pd(_mm256_mul_pd(_mm256_broadcast_sd(pl + 2), cz), _mm256_broadcast_sd(pl + 3)));
+            outside |= _mm256_movemask_pd(_mm256_cmp_pd(d, negative_radius, _CMP_LT_OQ));
+        }
+
+        for (uint32_t lane = 0; lane < 4; ++lane)
+        {
+            if ((outside & (1 << lane)) == 0) visible[numVisible++] = i + lane;
+        }
+    }
+#elif defined(VSG_BATCH_INTERSECT_SSE2)
+    const int allOutside = 0x3;
+    for (; (i + 2) <= count; i += 2)
+    {
+        __m128d cx = _mm_loadu_pd(x + i);
+        __m128d cy = _mm_loadu_pd(y + i);
+        __m128d cz = _mm_loadu_pd(z + i);
+        __m128d negative_radius = _mm_sub_pd(_mm_setzero_pd(), _mm_loadu_pd(radius + i));
+
+        int outside = 0;
+        for (uint32_t p = 0; p < numPlanes && outside != allOutside; ++p)
+        {
+            const double* pl = planes[p].value;
+            __m128d d = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(pl[0]), cx), _mm_mul_pd(_mm_set1_pd(pl[1]), cy)),
+                                   _mm_add_pd(_mm_mul_pd(_mm_set1_pd(pl[2]), cz), _mm_set1_pd(pl[3])));
+            outside |= _mm_movemask_pd(_mm_cmplt_pd(d, negative_radius));
+        }
+
+        if ((outside & 1) == 0) visible[numVisible++] = i;
+        if ((outside & 2) == 0) visible[numVisible++] = i + 1;
+    }
+#elif defined(VSG_BATCH_INTERSECT_NEON)
+    for (; (i + 2) <= count; i += 2)
+    {
+        float64x2_t cx = vld1q_f64(x + i);
+        float64x2_t cy = vld1q_f64(y + i);
+        float64x2_t cz = vld1q_f64(z + i);
+        float64x2_t negative_radius = vnegq_f64(vld1q_f64(radius + i));
+
+        uint64x2_t outside = vdupq_n_u64(0);
+        for (uint32_t p = 0; p < numPlanes; ++p)
+        {
+            const double* pl = planes[p].value;
+            float64x2_t d = vfmaq_n_f64(vfmaq_n_f64(vfmaq_n_f64(vdupq_n_f64(pl[3]), cx, pl[0]), cy, pl[1]), cz, pl[2]);
+            outside = vorrq_u64(outside, vcltq_f64(d, negative_radius));
+            if ((vgetq_lane_u64(outside, 0) & vgetq_lane_u64(outside, 1)) != 0) break;
+        }
+
+        if (vgetq_lane_u64(outside, 0) == 0) visible[numVisible++] = i;
+        if (vgetq_lane_u64(outside, 1) == 0) visible[numVisible++] = i + 1;
+    }
+#endif
+
+    // scalar fallback for the remaining spheres, or all of them when no SIMD instructions are enabled
+    for (; i < count; ++i)
+    {
+        double negative_radius = -radius[i];
+        bool inside = true;
+        for (uint32_t p = 0; p < numPlanes && inside; ++p)
+        {
+            const auto& pl = planes[p];
+            inside = !((pl.n.x * x[i] + pl.n.y * y[i] + pl.n.z * z[i] + pl.p) < negative_radius);
+        }
+        if (inside) visible[numVisible++] = i;
+    }
+
+    return numVisible;
+}
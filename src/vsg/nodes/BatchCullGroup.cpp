@@ -0,0 +1,87 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/stream.h>
+#include <vsg/nodes/BatchCullGroup.h>
+
+#include <cassert>
+
+using namespace vsg;
+
+BatchCullGroup::BatchCullGroup(Allocator* allocator) :
+    Inherit(allocator)
+{
+}
+
+BatchCullGroup::~BatchCullGroup()
+{
+}
+
+void BatchCullGroup::addChild(const dsphere& bound, ref_ptr<Node> child)
+{
+    _children.emplace_back(child);
+    _centerX.push_back(bound.x);
+    _centerY.push_back(bound.y);
+    _centerZ.push_back(bound.z);
+    _radius.push_back(bound.r);
+
+    assert(_centerX.size() == _children.size() && _centerY.size() == _children.size() && _centerZ.size() == _children.size() && _radius.size() == _children.size());
+}
+
+void BatchCullGroup::setChild(std::size_t pos, const dsphere& bound, ref_ptr<Node> child)
+{
+    assert(pos < _children.size() && _radius.size() == _children.size());
+
+    _children[pos] = child;
+    setBound(pos, bound);
+}
+
+void BatchCullGroup::setBound(std::size_t pos, const dsphere& bound)
+{
+    _centerX[pos] = bound.x;
+    _centerY[pos] = bound.y;
+    _centerZ[pos] = bound.z;
+    _radius[pos] = bound.r;
+}
+
+void BatchCullGroup::read(Input& input)
+{
+    Node::read(input);
+
+    auto numChildren = input.readValue<uint32_t>("NumChildren");
+    _children.resize(numChildren);
+    _centerX.resize(numChildren);
+    _centerY.resize(numChildren);
+    _centerZ.resize(numChildren);
+    _radius.resize(numChildren);
+
+    for (uint32_t i = 0; i < numChildren; ++i)
+    {
+        dsphere bound;
+        input.read("Bound", bound);
+        input.readObject("Child", _children[i]);
+        setBound(i, bound);
+    }
+}
+
+void BatchCullGroup::write(Output& output) const
+{
+    Node::write(output);
+
+    output.writeValue<uint32_t>("NumChildren", _children.size());
+    for (std::size_t i = 0; i < _children.size(); ++i)
+    {
+        auto bound = getBound(i);
+        output.write("Bound", bound);
+        output.writeObject("Child", _children[i]);
+    }
+}
@@ -42,6 +42,11 @@ Geometry::~Geometry()
 {
 }
 
+void Geometry::release()
+{
+    _vulkanData.clear();
+}
+
 void Geometry::read(Input& input)
 {
     Node::read(input);
@@ -154,13 +159,11 @@ void Geometry::dispatch(CommandBuffer& commandBuffer) const
 {
     auto& vkd = _vulkanData[commandBuffer.deviceID];
 
-    VkCommandBuffer cmdBuffer{commandBuffer};
-
-    vkCmdBindVertexBuffers(cmdBuffer, firstBinding, static_cast<uint32_t>(vkd.vkBuffers.size()), vkd.vkBuffers.data(), vkd.offsets.data());
+    commandBuffer.bindVertexBuffers(firstBinding, static_cast<uint32_t>(vkd.vkBuffers.size()), vkd.vkBuffers.data(), vkd.offsets.data());
 
     if (indices)
     {
-        vkCmdBindIndexBuffer(cmdBuffer, *(vkd.bufferData._buffer), vkd.bufferData._offset, vkd.indexType);
+        commandBuffer.bindIndexBuffer(*(vkd.bufferData._buffer), vkd.bufferData._offset, vkd.indexType);
     }
 
     for (auto& command : commands)
@@ -27,7 +27,8 @@ using namespace vsg;
 // PagedLOD
 //
 PagedLOD::PagedLOD(Allocator* allocator) :
-    Inherit(allocator)
+    Inherit(allocator),
+    _children(2)
 {
     //    ++s_numPagedLODS;
 }
@@ -44,21 +45,45 @@ void PagedLOD::read(Input& input)
 
     input.read("Bound", _bound);
 
-    input.read("MinimumScreenHeightRatio", _children[0].minimumScreenHeightRatio);
-    input.read("Filename", filename);
-    _children[0].node = nullptr;
+    auto path = filePath(input.filename);
 
-    if (!input.filename.empty())
+    if (input.version_less(0, 0, 1))
     {
-        auto path = filePath(input.filename);
-        if (!path.empty())
+        // files written before N child support have an external child 0 and a resident child 1
+        _children.resize(2);
+
+        auto& externalChild = _children[0];
+        input.read("MinimumScreenHeightRatio", externalChild.minimumScreenHeightRatio);
+        input.read("Filename", externalChild.filename);
+
+        auto& residentChild = _children[1];
+        input.read("MinimumScreenHeightRatio", residentChild.minimumScreenHeightRatio);
+        input.readObject("Child", residentChild.node);
+        residentChild.filename.clear();
+    }
+    else
+    {
+        _children.resize(input.readValue<uint32_t>("NumChildren"));
+        for (auto& child : _children)
         {
-            filename = concatPaths(path, filename);
+            input.read("MinimumScreenHeightRatio", child.minimumScreenHeightRatio);
+            input.read("Filename", child.filename);
+            input.readObject("Child", child.node);
+
+            // GeometricError was added in 0.0.2
+            if (!input.version_less(0, 0, 2)) input.read("GeometricError", child.geometricError);
         }
     }
 
-    input.read("MinimumScreenHeightRatio", _children[1].minimumScreenHeightRatio);
-    input.readObject("Child", _children[1].node);
+    // external children are loaded by the DatabasePager relative to the file this PagedLOD was read from
+    for (auto& child : _children)
+    {
+        if (!child.filename.empty())
+        {
+            child.node = nullptr;
+            if (!path.empty()) child.filename = concatPaths(path, child.filename);
+        }
+    }
 
     options = input.options;
 }
@@ -69,11 +94,17 @@ void PagedLOD::write(Output& output) const
 
     output.write("Bound", _bound);
 
-    output.write("MinimumScreenHeightRatio", _children[0].minimumScreenHeightRatio);
-    output.write("Filename", filename);
+    output.writeValue<uint32_t>("NumChildren", _children.size());
+    for (auto& child : _children)
+    {
+        output.write("MinimumScreenHeightRatio", child.minimumScreenHeightRatio);
+        output.write("Filename", child.filename);
+
+        // external children are written out as their filename only
+        output.writeObject("Child", child.filename.empty() ? child.node.get() : nullptr);
 
-    output.write("MinimumScreenHeightRatio", _children[1].minimumScreenHeightRatio);
-    output.writeObject("Child", _children[1].node);
+        output.write("GeometricError", child.geometricError);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -222,10 +253,11 @@ void PagedLODContainer::_move(const PagedLOD* plod, List* targetList)
     auto& element = elements[plod->index];
     List* previousList = element.list;
 
-    if (previousList == targetList)
+    // moving within the same list moves the element to the tail, so that lists are ordered from least to most recently moved
+    if (previousList == targetList && targetList->tail == plod->index)
     {
 #if PRINT_CONTAINER
-        std::cout << "PagedLODContainer::move(" << plod << ") index = " << plod->index << ", already in " << targetList->name << std::endl;
+        std::cout << "PagedLODContainer::move(" << plod << ") index = " << plod->index << ", already at tail of " << targetList->name << std::endl;
 #endif
         return;
     }
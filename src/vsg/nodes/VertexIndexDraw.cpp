@@ -39,6 +39,11 @@ VertexIndexDraw::VertexIndexDraw(Allocator* allocator) :
 }
 
 VertexIndexDraw::~VertexIndexDraw()
+{
+    release();
+}
+
+void VertexIndexDraw::release()
 {
     for (auto& vkd : _vulkanData)
     {
@@ -52,6 +57,7 @@ VertexIndexDraw::~VertexIndexDraw()
         }
         if (vkd.bufferData._buffer) vkd.bufferData._buffer->release(vkd.bufferData._offset, vkd.bufferData._range);
     }
+    _vulkanData.clear();
 }
 
 void VertexIndexDraw::read(Input& input)
@@ -154,9 +160,9 @@ void VertexIndexDraw::dispatch(CommandBuffer& commandBuffer) const
 
     VkCommandBuffer cmdBuffer{commandBuffer};
 
-    vkCmdBindVertexBuffers(cmdBuffer, firstBinding, static_cast<uint32_t>(vkd.vkBuffers.size()), vkd.vkBuffers.data(), vkd.offsets.data());
+    commandBuffer.bindVertexBuffers(firstBinding, static_cast<uint32_t>(vkd.vkBuffers.size()), vkd.vkBuffers.data(), vkd.offsets.data());
 
-    vkCmdBindIndexBuffer(cmdBuffer, *(vkd.bufferData._buffer), vkd.bufferData._offset, vkd.indexType);
+    commandBuffer.bindIndexBuffer(*(vkd.bufferData._buffer), vkd.bufferData._offset, vkd.indexType);
 
     vkCmdDrawIndexed(cmdBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
@@ -109,9 +109,10 @@ static void pthread_setAffinity(pthread_t thread_native_handle, const vsg::Affin
 
     if (affinity)
     {
+        // logical CPU numbers can exceed the number of processors when some are offline, see CPUTopology
         for(auto cpu : affinity.cpus)
         {
-            if (cpu < numProcessors)
+            if (cpu < CPU_SETSIZE)
             {
                 CPU_SET(cpu, &cpuset);
             }
@@ -0,0 +1,187 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/CPUTopology.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace vsg;
+
+#if defined(__linux__)
+// read a single line from a /sys file, returns false if the file couldn't be read.
+static bool readLine(const std::string& filename, std::string& line)
+{
+    std::ifstream fin(filename);
+    if (!fin) return false;
+    return static_cast<bool>(std::getline(fin, line));
+}
+
+// parse the /sys list format, such as "0-3,8-11", into a set of numbers.
+static std::set<uint32_t> parseList(const std::string& line)
+{
+    std::set<uint32_t> values;
+    std::stringstream str(line);
+    std::string range;
+    while (std::getline(str, range, ','))
+    {
+        if (range.empty()) continue;
+
+        auto dash = range.find('-');
+        uint32_t first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+        uint32_t last = (dash != std::string::npos) ? static_cast<uint32_t>(std::stoul(range.substr(dash + 1))) : first;
+        for (uint32_t i = first; i <= last; ++i) values.insert(i);
+    }
+    return values;
+}
+
+static bool readLinuxTopology(CPUTopology::LogicalCPUs& logicalCPUs)
+{
+    std::string line;
+    if (!readLine("/sys/devices/system/cpu/online", line)) return false;
+
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> coreIndices;
+    std::map<uint32_t, size_t> cpuIndices;
+    for (auto cpu : parseList(line))
+    {
+        CPUTopology::LogicalCPU logicalCPU;
+        logicalCPU.cpu = cpu;
+
+        std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+        uint32_t coreID = cpu;
+        if (readLine(topology + "physical_package_id", line)) logicalCPU.package = static_cast<uint32_t>(std::stoul(line));
+        if (readLine(topology + "core_id", line)) coreID = static_cast<uint32_t>(std::stoul(line));
+
+        // core_id is only unique within a package
+        auto itr = coreIndices.emplace(std::make_pair(logicalCPU.package, coreID), static_cast<uint32_t>(coreIndices.size())).first;
+        logicalCPU.core = itr->second;
+
+        cpuIndices[cpu] = logicalCPUs.size();
+        logicalCPUs.push_back(logicalCPU);
+    }
+
+    // NUMA nodes are optional, kernels built without NUMA support don't provide /sys/devices/system/node
+    if (readLine("/sys/devices/system/node/online", line))
+    {
+        for (auto node : parseList(line))
+        {
+            std::string cpulist;
+            if (!readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", cpulist)) continue;
+
+            for (auto cpu : parseList(cpulist))
+            {
+                if (auto itr = cpuIndices.find(cpu); itr != cpuIndices.end()) logicalCPUs[itr->second].node = node;
+            }
+        }
+    }
+
+    return !logicalCPUs.empty();
+}
+#endif
+
+CPUTopology::CPUTopology()
+{
+#if defined(__linux__)
+    if (readLinuxTopology(logicalCPUs)) return;
+    logicalCPUs.clear();
+#endif
+
+    // no topology information so treat each logical CPU as a separate physical core
+    uint32_t numProcessors = std::max(std::thread::hardware_concurrency(), 1u);
+    for (uint32_t cpu = 0; cpu < numProcessors; ++cpu)
+    {
+        LogicalCPU logicalCPU;
+        logicalCPU.cpu = cpu;
+        logicalCPU.core = cpu;
+        logicalCPUs.push_back(logicalCPU);
+    }
+}
+
+CPUTopology::~CPUTopology()
+{
+}
+
+uint32_t CPUTopology::numPhysicalCores() const
+{
+    std::set<uint32_t> cores;
+    for (auto& logicalCPU : logicalCPUs) cores.insert(logicalCPU.core);
+    return static_cast<uint32_t>(cores.size());
+}
+
+uint32_t CPUTopology::numNodes() const
+{
+    std::set<uint32_t> nodes;
+    for (auto& logicalCPU : logicalCPUs) nodes.insert(logicalCPU.node);
+    return static_cast<uint32_t>(nodes.size());
+}
+
+Affinity CPUTopology::all(int node) const
+{
+    Affinity affinity;
+    for (auto& logicalCPU : logicalCPUs)
+    {
+        if (node < 0 || logicalCPU.node == static_cast<uint32_t>(node)) affinity.cpus.insert(logicalCPU.cpu);
+    }
+    return affinity;
+}
+
+Affinity CPUTopology::physicalCores(int node) const
+{
+    Affinity affinity;
+    std::set<uint32_t> cores;
+    for (auto& logicalCPU : logicalCPUs)
+    {
+        if (node >= 0 && logicalCPU.node != static_cast<uint32_t>(node)) continue;
+        if (cores.insert(logicalCPU.core).second) affinity.cpus.insert(logicalCPU.cpu);
+    }
+    return affinity;
+}
+
+Affinity CPUTopology::siblings(uint32_t cpu) const
+{
+    Affinity affinity;
+    auto itr = std::find_if(logicalCPUs.begin(), logicalCPUs.end(), [cpu](const LogicalCPU& logicalCPU) { return logicalCPU.cpu == cpu; });
+    if (itr == logicalCPUs.end()) return affinity;
+
+    for (auto& logicalCPU : logicalCPUs)
+    {
+        if (logicalCPU.core == itr->core) affinity.cpus.insert(logicalCPU.cpu);
+    }
+    return affinity;
+}
+
+Affinities CPUTopology::perPhysicalCore(int node) const
+{
+    Affinities affinities;
+    std::map<uint32_t, size_t> coreIndices;
+    for (auto& logicalCPU : logicalCPUs)
+    {
+        if (node >= 0 && logicalCPU.node != static_cast<uint32_t>(node)) continue;
+
+        auto [itr, inserted] = coreIndices.emplace(logicalCPU.core, affinities.size());
+        if (inserted) affinities.emplace_back();
+        affinities[itr->second].cpus.insert(logicalCPU.cpu);
+    }
+    return affinities;
+}
+
+Affinities vsg::perCPU(const Affinity& affinity)
+{
+    Affinities affinities;
+    for (auto cpu : affinity.cpus)
+    {
+        affinities.emplace_back(cpu);
+    }
+    return affinities;
+}
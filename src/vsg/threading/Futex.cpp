@@ -0,0 +1,73 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/Futex.h>
+
+#if defined(__linux__)
+#    include <climits>
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+using namespace vsg;
+
+#if defined(__linux__)
+
+void Futex::_block(std::atomic_int& value, int expected)
+{
+    ++_numWaiting;
+
+    // pairs with the fence in wake_all() so either the waking thread sees the waiting count or this thread sees the new value,
+    // the kernel also checks value == expected atomically before sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (value.load() == expected)
+    {
+        syscall(SYS_futex, reinterpret_cast<int*>(&value), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+
+    --_numWaiting;
+}
+
+void Futex::wake_all(std::atomic_int& value)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_numWaiting.load(std::memory_order_relaxed) > 0)
+    {
+        syscall(SYS_futex, reinterpret_cast<int*>(&value), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+}
+
+#else
+
+void Futex::_block(std::atomic_int& value, int expected)
+{
+    std::unique_lock lock(_mutex);
+    ++_numWaiting;
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (value.load() == expected) _cv.wait(lock);
+
+    --_numWaiting;
+}
+
+void Futex::wake_all(std::atomic_int&)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_numWaiting.load(std::memory_order_relaxed) > 0)
+    {
+        std::scoped_lock lock(_mutex);
+        _cv.notify_all();
+    }
+}
+
+#endif
@@ -14,45 +14,49 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 using namespace vsg;
 
-OperationQueue::OperationQueue(ref_ptr<Active> in_active) :
+OperationQueue::OperationQueue(ref_ptr<Active> in_active, size_t capacity) :
+    _queue(capacity),
     _active(in_active)
 {
 }
 
-ref_ptr<Operation> OperationQueue::take()
+void OperationQueue::_addToOverflow(ref_ptr<Operation> operation)
 {
-    std::unique_lock lock(_mutex);
-
-    if (_queue.empty()) return {};
-
-    ref_ptr<Operation> operation = _queue.front();
-
-    _queue.erase(_queue.begin());
+    {
+        std::scoped_lock lock(_overflowMutex);
+        _overflow.emplace_back(operation);
+        ++_numOverflow;
+    }
 
-    return operation;
+    // wake a thread blocked in take_when_avilable()
+    _queue.notify();
 }
 
-ref_ptr<Operation> OperationQueue::take_when_avilable()
+ref_ptr<Operation> OperationQueue::take()
 {
-    std::chrono::duration waitDuration = std::chrono::milliseconds(100);
-
-    std::unique_lock lock(_mutex);
-
-    // wait to the conditional variable signals that an operation has been added
-    while (_queue.empty() && *_active)
+    // the ring buffer holds the operations added before any in the overflow, so take from it first
+    ref_ptr<Operation> operation;
+    if (!_queue.take(operation) && _numOverflow.load() > 0)
     {
-        //std::cout<<"Waiting on condition variable"<<std::endl;
-        _cv.wait_for(lock, waitDuration);
+        std::scoped_lock lock(_overflowMutex);
+        if (!_overflow.empty())
+        {
+            operation = _overflow.front();
+            _overflow.pop_front();
+            --_numOverflow;
+        }
     }
+    return operation;
+}
 
+ref_ptr<Operation> OperationQueue::take_when_avilable()
+{
     // if the threads we are associated with should no longer running go for a quick exit and return nothing.
-    if (!*_active)
+    while (_active->active)
     {
-        return {};
-    }
+        if (auto operation = take()) return operation;
 
-    // remove and return the head of the queue
-    ref_ptr<Operation> operation = _queue.front();
-    _queue.erase(_queue.begin());
-    return operation;
+        _queue.wait(_active->active, [this]() { return _numOverflow.load() == 0; });
+    }
+    return {};
 }
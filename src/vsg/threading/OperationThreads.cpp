@@ -14,26 +14,42 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 using namespace vsg;
 
-OperationThreads::OperationThreads(uint32_t numThreads, ref_ptr<Active> in_active) :
-    active(in_active)
+static void runOperations(ref_ptr<OperationQueue> q, ref_ptr<Active> a, Affinity affinity, ThreadPriority priority)
 {
-    if (!active) active = new Active;
-    queue = new OperationQueue(active);
+    if (affinity) setAffinity(affinity);
+    setThreadPriority(priority);
 
-    auto run = [](ref_ptr<OperationQueue> q, ref_ptr<Active> a) {
-        while (*(a))
+    while (*(a))
+    {
+        ref_ptr<Operation> operation = q->take_when_avilable();
+        if (operation)
         {
-            ref_ptr<Operation> operation = q->take_when_avilable();
-            if (operation)
-            {
-                operation->run();
-            }
+            operation->run();
         }
-    };
+    }
+}
+
+OperationThreads::OperationThreads(uint32_t numThreads, ref_ptr<Active> in_active, ThreadPriority priority) :
+    active(in_active)
+{
+    if (!active) active = new Active;
+    queue = new OperationQueue(active);
 
     for (size_t i = 0; i < numThreads; ++i)
     {
-        threads.emplace_back(std::thread(run, std::ref(queue), std::ref(active)));
+        threads.emplace_back(std::thread(runOperations, std::ref(queue), std::ref(active), Affinity(), priority));
+    }
+}
+
+OperationThreads::OperationThreads(const Affinities& affinities, ref_ptr<Active> in_active, ThreadPriority priority) :
+    active(in_active)
+{
+    if (!active) active = new Active;
+    queue = new OperationQueue(active);
+
+    for (auto& affinity : affinities)
+    {
+        threads.emplace_back(std::thread(runOperations, std::ref(queue), std::ref(active), affinity, priority));
     }
 }
 
@@ -48,6 +64,8 @@ void OperationThreads::run()
 void OperationThreads::stop()
 {
     active->active.exchange(false);
+    queue->release();
+
     for (auto& thread : threads)
     {
         thread.join();
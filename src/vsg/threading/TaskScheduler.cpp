@@ -0,0 +1,320 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/TaskScheduler.h>
+
+using namespace vsg;
+
+// the TaskScheduler and worker index of the calling thread, if it's a TaskScheduler worker thread
+static thread_local const TaskScheduler* s_currentScheduler = nullptr;
+static thread_local uint32_t s_currentWorkerIndex = 0;
+
+// TaskGroupOperation runs an operation added to a TaskGroup and counts down the group's latch once it completes
+class TaskGroupOperation : public Inherit<Operation, TaskGroupOperation>
+{
+public:
+    TaskGroupOperation(ref_ptr<Operation> in_operation, ref_ptr<Latch> in_latch) :
+        operation(in_operation),
+        latch(in_latch) {}
+
+    void run() override
+    {
+        operation->run();
+        latch->count_down();
+    }
+
+    ref_ptr<Operation> operation;
+    ref_ptr<Latch> latch;
+};
+
+// operations discarded without being run still count down their TaskGroup's latch, so that TaskGroup::wait() doesn't wait on them forever
+static void discard(ref_ptr<Operation> operation)
+{
+    if (auto groupOperation = operation.cast<TaskGroupOperation>()) groupOperation->latch->count_down();
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+// TaskScheduler
+//
+TaskScheduler::TaskScheduler(uint32_t numThreads, ref_ptr<Active> in_active, ThreadPriority priority) :
+    active(in_active),
+    _injected(4096)
+{
+    if (!active) active = Active::create();
+
+    if (numThreads == 0)
+    {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        numThreads = (hardwareThreads > 1) ? (hardwareThreads - 1) : 1;
+    }
+
+    // create all the workers before starting the threads so that they can steal from each other straight away
+    for (uint32_t i = 0; i < numThreads; ++i)
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->scheduler = this;
+        worker->index = i;
+        worker->priority = priority;
+        _workers.emplace_back(std::move(worker));
+    }
+
+    auto run = [](Worker* worker) {
+        s_currentScheduler = worker->scheduler;
+        s_currentWorkerIndex = worker->index;
+        setThreadPriority(worker->priority);
+
+        auto scheduler = worker->scheduler;
+        while (*(scheduler->active))
+        {
+            if (auto operation = scheduler->_take(worker))
+            {
+                operation->run();
+            }
+            else
+            {
+                scheduler->_wait();
+            }
+        }
+
+        s_currentScheduler = nullptr;
+    };
+
+    for (auto& worker : _workers)
+    {
+        worker->thread = std::thread(run, worker.get());
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    stop();
+}
+
+uint32_t TaskScheduler::getWorkerIndex() const
+{
+    return (s_currentScheduler == this) ? s_currentWorkerIndex : static_cast<uint32_t>(_workers.size());
+}
+
+void TaskScheduler::add(ref_ptr<Operation> operation)
+{
+    if (!operation) return;
+
+    // the workers have been stopped so the operation would never be run
+    if (!*active)
+    {
+        discard(operation);
+        return;
+    }
+
+    // count the operation before it becomes visible so that _numPending can't underflow when it's taken
+    ++_numPending;
+
+    uint32_t workerIndex = getWorkerIndex();
+    if (workerIndex < _workers.size())
+    {
+        // nested operations go on the end of the calling worker's deque, so that it runs them first while they are still hot in cache
+        auto& worker = *_workers[workerIndex];
+        std::scoped_lock lock(worker.mutex);
+        worker.operations.emplace_back(operation);
+    }
+    else
+    {
+        // once the ring buffer has overflowed, operations go to the overflow till it's been emptied so that they are still taken in the order they were added
+        if (_numOverflow.load() > 0 || !_injected.push(operation))
+        {
+            std::scoped_lock lock(_overflowMutex);
+            _overflow.emplace_back(operation);
+            ++_numOverflow;
+        }
+    }
+
+    _notify();
+}
+
+bool TaskScheduler::run_one()
+{
+    uint32_t workerIndex = getWorkerIndex();
+    Worker* worker = (workerIndex < _workers.size()) ? _workers[workerIndex].get() : nullptr;
+
+    if (auto operation = _take(worker))
+    {
+        operation->run();
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::run()
+{
+    while (run_one()) {}
+}
+
+void TaskScheduler::setAffinity(const Affinity& affinity)
+{
+    if (!affinity || affinity.cpus.size() < _workers.size())
+    {
+        for (auto& worker : _workers)
+        {
+            vsg::setAffinity(worker->thread, affinity);
+        }
+        return;
+    }
+
+    auto cpu_itr = affinity.cpus.begin();
+    for (auto& worker : _workers)
+    {
+        vsg::setAffinity(worker->thread, Affinity(*cpu_itr++));
+    }
+}
+
+void TaskScheduler::stop()
+{
+    active->active.exchange(false);
+
+    {
+        std::scoped_lock lock(_mutex);
+        _cv.notify_all();
+    }
+
+    for (auto& worker : _workers)
+    {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+
+    // discard any operations that weren't run. The Workers themselves are kept as add(), run_one() and _steal() may still be reading _workers from other threads
+    for (auto& worker : _workers)
+    {
+        std::scoped_lock lock(worker->mutex);
+        for (auto& operation : worker->operations) discard(operation);
+        worker->operations.clear();
+    }
+
+    ref_ptr<Operation> operation;
+    while (_injected.take(operation)) discard(operation);
+    {
+        std::scoped_lock lock(_overflowMutex);
+        for (auto& overflowOperation : _overflow) discard(overflowOperation);
+        _overflow.clear();
+        _numOverflow = 0;
+    }
+    _numPending = 0;
+}
+
+ref_ptr<Operation> TaskScheduler::_take(Worker* worker)
+{
+    ref_ptr<Operation> operation;
+
+    // most recently added operation from our own deque
+    if (worker)
+    {
+        std::scoped_lock lock(worker->mutex);
+        if (!worker->operations.empty())
+        {
+            operation = worker->operations.back();
+            worker->operations.pop_back();
+        }
+    }
+
+    // operations added from outside the scheduler, the ring buffer holds those added before any in the overflow
+    if (!operation && !_injected.take(operation) && _numOverflow.load() > 0)
+    {
+        std::scoped_lock lock(_overflowMutex);
+        if (!_overflow.empty())
+        {
+            operation = _overflow.front();
+            _overflow.pop_front();
+            --_numOverflow;
+        }
+    }
+
+    // least recently added operation from one of the other workers
+    if (!operation) operation = _steal(worker ? (worker->index + 1) : 0);
+
+    if (operation) --_numPending;
+    return operation;
+}
+
+ref_ptr<Operation> TaskScheduler::_steal(uint32_t startIndex)
+{
+    size_t numWorkers = _workers.size();
+    for (size_t i = 0; i < numWorkers; ++i)
+    {
+        auto& victim = *_workers[(startIndex + i) % numWorkers];
+
+        std::scoped_lock lock(victim.mutex);
+        if (!victim.operations.empty())
+        {
+            auto operation = victim.operations.front();
+            victim.operations.pop_front();
+            return operation;
+        }
+    }
+    return {};
+}
+
+void TaskScheduler::_wait()
+{
+    ++_numWaiting;
+
+    // pairs with the fence in _notify() so either the waiting thread sees the pending operation or the adding thread sees the waiting count
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+        std::unique_lock lock(_mutex);
+        if (_numPending.load() == 0 && *active) _cv.wait_for(lock, std::chrono::milliseconds(100));
+    }
+
+    --_numWaiting;
+}
+
+void TaskScheduler::_notify()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_numWaiting.load(std::memory_order_relaxed) > 0)
+    {
+        std::scoped_lock lock(_mutex);
+        _cv.notify_one();
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+// TaskGroup
+//
+TaskGroup::TaskGroup(ref_ptr<TaskScheduler> in_scheduler) :
+    scheduler(in_scheduler),
+    _latch(Latch::create(0))
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+}
+
+void TaskGroup::add(ref_ptr<Operation> operation)
+{
+    if (!operation) return;
+
+    _latch->count_up();
+
+    scheduler->add(TaskGroupOperation::create(operation, _latch));
+}
+
+void TaskGroup::wait()
+{
+    // help run pending operations rather than blocking, so waiting from within an operation can't starve the workers.
+    // Once there's nothing left to run, the group's remaining operations are running on other threads so block till they complete.
+    while (!_latch->is_ready())
+    {
+        if (!scheduler->run_one()) _latch->wait();
+    }
+}
@@ -0,0 +1,94 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/ThreadPriority.h>
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+bool vsg::setThreadPriority(ThreadPriority priority)
+{
+    int nPriority = THREAD_PRIORITY_NORMAL;
+    switch (priority)
+    {
+    case (ThreadPriority::Default): return true;
+    case (ThreadPriority::Low): nPriority = THREAD_PRIORITY_BELOW_NORMAL; break;
+    case (ThreadPriority::Background): nPriority = THREAD_PRIORITY_LOWEST; break;
+    case (ThreadPriority::Idle): nPriority = THREAD_PRIORITY_IDLE; break;
+    }
+
+    return SetThreadPriority(GetCurrentThread(), nPriority) != 0;
+}
+
+#elif defined(__APPLE__)
+
+#include <pthread.h>
+#include <pthread/qos.h>
+
+bool vsg::setThreadPriority(ThreadPriority priority)
+{
+    qos_class_t qos = QOS_CLASS_DEFAULT;
+    switch (priority)
+    {
+    case (ThreadPriority::Default): return true;
+    case (ThreadPriority::Low): qos = QOS_CLASS_UTILITY; break;
+    case (ThreadPriority::Background): qos = QOS_CLASS_BACKGROUND; break;
+    case (ThreadPriority::Idle): qos = QOS_CLASS_BACKGROUND; break;
+    }
+
+    return pthread_set_qos_class_self_np(qos, 0) == 0;
+}
+
+#elif defined(__linux__)
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// under Linux the nice value is per thread, set via the thread id rather than the process id
+static bool linux_setNice(int nice)
+{
+    auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, tid, nice) == 0;
+}
+
+static bool linux_setScheduler(int policy)
+{
+    sched_param param = {};
+    param.sched_priority = 0;
+    return pthread_setschedparam(pthread_self(), policy, &param) == 0;
+}
+
+bool vsg::setThreadPriority(ThreadPriority priority)
+{
+    switch (priority)
+    {
+    case (ThreadPriority::Default): return true;
+    case (ThreadPriority::Low): return linux_setNice(5);
+    case (ThreadPriority::Background): return linux_setScheduler(SCHED_BATCH) && linux_setNice(10);
+    case (ThreadPriority::Idle): return linux_setScheduler(SCHED_IDLE);
+    }
+    return false;
+}
+
+#else
+
+bool vsg::setThreadPriority(ThreadPriority priority)
+{
+    // no per thread priority support on this platform
+    return priority == ThreadPriority::Default;
+}
+
+#endif
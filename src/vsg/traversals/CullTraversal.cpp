@@ -11,20 +11,76 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/traversals/CullTraversal.h>
+#include <vsg/traversals/DrawList.h>
+#include <vsg/traversals/RecordTraversal.h>
+#include <vsg/traversals/traversePagedLOD.h>
 
+#include <vsg/nodes/Commands.h>
+#include <vsg/nodes/BatchCullGroup.h>
+#include <vsg/nodes/CullGroup.h>
+#include <vsg/nodes/CullNode.h>
 #include <vsg/nodes/Group.h>
 #include <vsg/nodes/LOD.h>
+#include <vsg/nodes/MatrixTransform.h>
+#include <vsg/nodes/PagedLOD.h>
 #include <vsg/nodes/QuadGroup.h>
 #include <vsg/nodes/StateGroup.h>
 
+#include <vsg/vk/BindIndexBuffer.h>
+#include <vsg/vk/BindVertexBuffers.h>
 #include <vsg/vk/Command.h>
 #include <vsg/vk/CommandBuffer.h>
+#include <vsg/vk/GraphicsPipeline.h>
 #include <vsg/vk/RenderPass.h>
+#include <vsg/vk/State.h>
 
+#include <cstring>
 #include <iostream>
 
 using namespace vsg;
 
+CullTraversal::CullTraversal(uint32_t maxSlot, ref_ptr<FrameStamp> fs) :
+    drawList(DrawList::create(maxSlot + 1)),
+    frameStamp(fs),
+    state(new State(nullptr, maxSlot))
+{
+}
+
+CullTraversal::~CullTraversal()
+{
+}
+
+void CullTraversal::setProjectionAndViewMatrix(const dmat4& projMatrix, const dmat4& viewMatrix)
+{
+    state->setProjectionAndViewMatrix(projMatrix, viewMatrix);
+    _matrixIndex = invalidIndex;
+}
+
+void CullTraversal::reset(const RecordTraversal& recordTraversal)
+{
+    numNodes = 0;
+
+    state->inherit(*recordTraversal.state);
+
+    drawList->clear();
+    drawList->numSlots = static_cast<uint32_t>(state->stateStacks.size());
+
+    databasePager = recordTraversal.databasePager;
+    culledPagedLODs = recordTraversal.culledPagedLODs;
+    frameStamp = recordTraversal.frameStamp;
+    prefetch = recordTraversal.prefetch;
+    prefetchEyeOffset.set(recordTraversal.prefetchEyeOffset.x, recordTraversal.prefetchEyeOffset.y, recordTraversal.prefetchEyeOffset.z);
+
+    _stateIndex = invalidIndex;
+    _matrixIndex = invalidIndex;
+    _drawItemBegin = invalidIndex;
+    _drawItemBin = nullptr;
+    _depthValid = false;
+
+    // StateCommand may have been deleted since the last frame, so ranks can't be carried over
+    _stateInfos.clear();
+}
+
 void CullTraversal::apply(const Object& object)
 {
     //    std::cout<<"Visiting object"<<std::endl;
@@ -53,25 +109,190 @@ void CullTraversal::apply(const QuadGroup& object)
     object.traverse(*this);
 }
 
-void CullTraversal::apply(const LOD& object)
+template<class T>
+void CullTraversal::_traverseBound(const T& node, const dsphere& bound)
+{
+    // the depth of the bounding sphere centre is used for the Commands in the subgraph
+    const auto& mv = state->modelviewMatrixStack.top();
+    double previousDepth = _depth;
+    bool previousDepthValid = _depthValid;
+
+    _depth = -(mv[0][2] * bound.x + mv[1][2] * bound.y + mv[2][2] * bound.z + mv[3][2]);
+    _depthValid = true;
+
+    node.traverse(*this);
+
+    _depth = previousDepth;
+    _depthValid = previousDepthValid;
+}
+
+void CullTraversal::apply(const LOD& lod)
 {
     //    std::cout<<"Visiting LOD "<<std::endl;
     ++numNodes;
-    object.traverse(*this);
+
+    auto sphere = lod.getBound();
+
+    // check if lod bounding sphere is in view frustum.
+    if (!state->intersect(sphere))
+    {
+        return;
+    }
+
+    const auto& proj = state->projectionMatrixStack.top();
+    const auto& mv = state->modelviewMatrixStack.top();
+    auto f = -proj[1][1];
+
+    auto z = mv[0][2] * sphere.x + mv[1][2] * sphere.y + mv[2][2] * sphere.z + mv[3][2];
+    auto distance = std::abs(z);
+    auto rf = sphere.r * f;
+
+    for (auto lodChild : lod.getChildren())
+    {
+        bool child_visible = rf > (lodChild.minimumScreenHeightRatio * distance);
+        if (child_visible)
+        {
+            double previousDepth = _depth;
+            bool previousDepthValid = _depthValid;
+            _depth = -z;
+            _depthValid = true;
+
+            lodChild.child->accept(*this);
+
+            _depth = previousDepth;
+            _depthValid = previousDepthValid;
+            return;
+        }
+    }
+}
+
+void CullTraversal::apply(const PagedLOD& plod)
+{
+    ++numNodes;
+
+    const auto& sphere = plod.getBound();
+    const auto& mv = state->modelviewMatrixStack.top();
+    double previousDepth = _depth;
+    bool previousDepthValid = _depthValid;
+    _depth = -(mv[0][2] * sphere.x + mv[1][2] * sphere.y + mv[2][2] * sphere.z + mv[3][2]);
+    _depthValid = true;
+
+    traversePagedLOD(*this, plod);
+
+    _depth = previousDepth;
+    _depthValid = previousDepthValid;
+}
+
+void CullTraversal::apply(const CullGroup& cullGroup)
+{
+    ++numNodes;
+    if (state->intersect(cullGroup.getBound()))
+    {
+        _traverseBound(cullGroup, cullGroup.getBound());
+    }
+}
+
+void CullTraversal::apply(const CullNode& cullNode)
+{
+    ++numNodes;
+    if (state->intersect(cullNode.getBound()))
+    {
+        _traverseBound(cullNode, cullNode.getBound());
+    }
+}
+
+void CullTraversal::apply(const BatchCullGroup& batchCullGroup)
+{
+    ++numNodes;
+
+    auto numChildren = static_cast<uint32_t>(batchCullGroup.getNumChildren());
+    if (numChildren == 0) return;
+
+    const double* x = batchCullGroup.getCenterX();
+    const double* y = batchCullGroup.getCenterY();
+    const double* z = batchCullGroup.getCenterZ();
+
+    size_t begin = _visibleIndices.size();
+    _visibleIndices.resize(begin + numChildren);
+    uint32_t numVisible = state->intersect(x, y, z, batchCullGroup.getRadius(), numChildren, _visibleIndices.data() + begin);
+    _visibleIndices.resize(begin + numVisible);
+
+    double previousDepth = _depth;
+    bool previousDepthValid = _depthValid;
+
+    for (uint32_t i = 0; i < numVisible; ++i)
+    {
+        uint32_t c = _visibleIndices[begin + i];
+
+        // the depth of each child's bounding sphere centre is used for the Commands in its subgraph, as in _traverseBound()
+        const auto& mv = state->modelviewMatrixStack.top();
+        _depth = -(mv[0][2] * x[c] + mv[1][2] * y[c] + mv[2][2] * z[c] + mv[3][2]);
+        _depthValid = true;
+
+        batchCullGroup.getChild(c)->accept(*this);
+    }
+
+    _depth = previousDepth;
+    _depthValid = previousDepthValid;
+
+    _visibleIndices.resize(begin);
+}
+
+void CullTraversal::apply(const MatrixTransform& mt)
+{
+    ++numNodes;
+
+    uint32_t previousMatrixIndex = _matrixIndex;
+    _matrixIndex = invalidIndex;
+
+    state->modelviewMatrixStack.pushAndPreMult(mt.getMatrix());
+    if (mt.getSubgraphRequiresLocalFrustum()) state->pushFrustum();
+
+    mt.traverse(*this);
+
+    if (mt.getSubgraphRequiresLocalFrustum()) state->popFrustum();
+    state->modelviewMatrixStack.pop();
+
+    _matrixIndex = previousMatrixIndex;
 }
-void CullTraversal::apply(const StateGroup& object)
+
+void CullTraversal::apply(const StateGroup& stateGroup)
 {
     //    std::cout<<"Visiting StateGroup "<<std::endl;
     ++numNodes;
-    object.traverse(*this);
+
+    uint32_t previousStateIndex = _stateIndex;
+    _stateIndex = invalidIndex;
+
+    const StateGroup::StateCommands& stateCommands = stateGroup.getStateCommands();
+    for (auto& command : stateCommands)
+    {
+        state->stateStacks[command->getSlot()].push(command);
+    }
+
+    stateGroup.traverse(*this);
+
+    for (auto& command : stateCommands)
+    {
+        state->stateStacks[command->getSlot()].pop();
+    }
+
+    _stateIndex = previousStateIndex;
 }
 
 // Vulkan nodes
-void CullTraversal::apply(const Command& object)
+void CullTraversal::apply(const Commands& commands)
+{
+    // Commands dispatches all its children, so it's added as a single drawable Command
+    ++numNodes;
+    _addCommand(commands);
+}
+
+void CullTraversal::apply(const Command& command)
 {
     //    std::cout<<"Visiting Command "<<std::endl;
     ++numNodes;
-    object.traverse(*this);
+    _addCommand(command);
 }
 
 void CullTraversal::apply(const CommandBuffer& object)
@@ -87,3 +308,106 @@ void CullTraversal::apply(const RenderPass& object)
     ++numNodes;
     object.traverse(*this);
 }
+
+const CullTraversal::StateInfo& CullTraversal::_getStateInfo(const StateCommand* stateCommand)
+{
+    auto itr = _stateInfos.find(stateCommand);
+    if (itr != _stateInfos.end()) return itr->second;
+
+    StateInfo info;
+    info.rank = static_cast<uint32_t>(_stateInfos.size());
+
+    if (auto bindPipeline = dynamic_cast<const BindGraphicsPipeline*>(stateCommand); bindPipeline && bindPipeline->getPipeline())
+    {
+        for (auto& pipelineState : bindPipeline->getPipeline()->getPipelineStates())
+        {
+            if (auto colorBlendState = pipelineState.cast<ColorBlendState>())
+            {
+                for (auto& attachment : colorBlendState->getColorBlendAttachments())
+                {
+                    if (attachment.blendEnable == VK_TRUE) info.transparent = true;
+                }
+            }
+        }
+    }
+
+    return _stateInfos[stateCommand] = info;
+}
+
+void CullTraversal::_addCommand(const Command& command)
+{
+    // binds set up the vertex and index buffers, pipeline state or push constants for the drawable Commands that follow them in the scene graph
+    bool bind = dynamic_cast<const BindVertexBuffers*>(&command) || dynamic_cast<const BindIndexBuffer*>(&command) || dynamic_cast<const StateCommand*>(&command);
+
+    // a bind that follows a drawable Command starts a new DrawItem
+    if (bind && _drawItemBin)
+    {
+        _drawItemBegin = invalidIndex;
+        _drawItemBin = nullptr;
+    }
+
+    auto& drawCommands = drawList->drawCommands;
+    if (_drawItemBegin == invalidIndex) _drawItemBegin = static_cast<uint32_t>(drawCommands.size());
+
+    auto& stateCommands = drawList->stateCommands;
+    uint32_t numSlots = drawList->numSlots;
+
+    // snapshot the top of the state stacks, shared by all the Commands added till the state next changes
+    if (_stateIndex == invalidIndex)
+    {
+        _stateIndex = static_cast<uint32_t>(stateCommands.size());
+        for (auto& stateStack : state->stateStacks)
+        {
+            stateCommands.push_back(stateStack.size() > 0 ? stateStack.stack.top().get() : nullptr);
+        }
+    }
+
+    const auto& mv = state->modelviewMatrixStack.top();
+    if (_matrixIndex == invalidIndex)
+    {
+        _matrixIndex = static_cast<uint32_t>(drawList->modelviewMatrices.size());
+        drawList->modelviewMatrices.emplace_back(mv);
+    }
+
+    drawCommands.push_back(DrawCommand{&command, _stateIndex, _matrixIndex});
+
+    // binds wait for the drawable Command that uses them, and drawable Commands following the first join its DrawItem, keeping the DrawItem's Commands contiguous
+    if (bind) return;
+    if (_drawItemBin)
+    {
+        ++(_drawItemBin->back().count);
+        return;
+    }
+
+    DrawItem drawItem;
+    drawItem.first = _drawItemBegin;
+    drawItem.count = static_cast<uint32_t>(drawCommands.size()) - _drawItemBegin;
+
+    // drawable Commands outside of any bounded subgraph use the depth of the local origin
+    drawItem.depth = _depthValid ? _depth : -mv[3][2];
+
+    // slot 0 is the pipeline and slot 1 the descriptor sets of the first drawable Command, each is ranked in the order first encountered so the opaque bin is grouped
+    // by pipeline then descriptor sets, with the depth ordering front to back within each group. Non negative floats compare the same as their bit patterns.
+    uint64_t pipelineRank = 0;
+    uint64_t descriptorRank = 0;
+    bool transparent = false;
+    if (numSlots > 0 && stateCommands[_stateIndex])
+    {
+        const auto& info = _getStateInfo(stateCommands[_stateIndex]);
+        pipelineRank = std::min(info.rank, 0xffffu);
+        transparent = info.transparent;
+    }
+    if (numSlots > 1 && stateCommands[_stateIndex + 1])
+    {
+        descriptorRank = std::min(_getStateInfo(stateCommands[_stateIndex + 1]).rank, 0xffffu);
+    }
+
+    float depth = static_cast<float>(std::max(drawItem.depth, 0.0));
+    uint32_t depthBits = 0;
+    std::memcpy(&depthBits, &depth, sizeof(depthBits));
+
+    drawItem.sortKey = (pipelineRank << 48) | (descriptorRank << 32) | depthBits;
+
+    _drawItemBin = transparent ? &(drawList->transparentBin) : &(drawList->opaqueBin);
+    _drawItemBin->push_back(drawItem);
+}
@@ -0,0 +1,41 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/traversals/DrawList.h>
+
+#include <algorithm>
+
+using namespace vsg;
+
+DrawList::DrawList(uint32_t in_numSlots) :
+    numSlots(in_numSlots)
+{
+}
+
+DrawList::~DrawList()
+{
+}
+
+void DrawList::clear()
+{
+    drawCommands.clear();
+    stateCommands.clear();
+    modelviewMatrices.clear();
+    opaqueBin.clear();
+    transparentBin.clear();
+}
+
+void DrawList::sort()
+{
+    std::stable_sort(opaqueBin.begin(), opaqueBin.end(), [](const DrawItem& lhs, const DrawItem& rhs) { return lhs.sortKey < rhs.sortKey; });
+    std::stable_sort(transparentBin.begin(), transparentBin.end(), [](const DrawItem& lhs, const DrawItem& rhs) { return lhs.depth > rhs.depth; });
+}
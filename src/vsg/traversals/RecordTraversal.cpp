@@ -12,6 +12,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/traversals/RecordTraversal.h>
 
+#include <vsg/nodes/BatchCullGroup.h>
 #include <vsg/nodes/Commands.h>
 #include <vsg/nodes/CullGroup.h>
 #include <vsg/nodes/CullNode.h>
@@ -36,6 +37,10 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/threading/atomics.h>
 
+#include <vsg/traversals/CullTraversal.h>
+#include <vsg/traversals/DrawList.h>
+#include <vsg/traversals/traversePagedLOD.h>
+
 using namespace vsg;
 
 #include <iostream>
@@ -114,86 +119,7 @@ void RecordTraversal::apply(const LOD& lod)
 
 void RecordTraversal::apply(const PagedLOD& plod)
 {
-    auto sphere = plod.getBound();
-
-    auto frameCount = frameStamp->frameCount;
-
-    // check if lod bounding sphere is in view frustum.
-    if (!state->intersect(sphere))
-    {
-        if ((frameCount - plod.frameHighResLastUsed) > 1 && culledPagedLODs)
-        {
-            culledPagedLODs->highresCulled.emplace_back(&plod);
-        }
-
-        return;
-    }
-
-    const auto& proj = state->projectionMatrixStack.top();
-    const auto& mv = state->modelviewMatrixStack.top();
-    auto f = -proj[1][1];
-
-    auto distance = std::abs(mv[0][2] * sphere.x + mv[1][2] * sphere.y + mv[2][2] * sphere.z + mv[3][2]);
-    auto rf = sphere.r * f;
-
-    // check the high res child to see if it's visible
-    {
-        const auto& child = plod.getChild(0);
-        auto cutoff = child.minimumScreenHeightRatio * distance;
-        bool child_visible = rf > cutoff;
-        if (child_visible)
-        {
-            auto previousHighResUsed = plod.frameHighResLastUsed.exchange(frameCount);
-            if (culledPagedLODs && ((frameCount - previousHighResUsed) > 1))
-            {
-                culledPagedLODs->newHighresRequired.emplace_back(&plod);
-            }
-
-            if (child.node)
-            {
-                // high res visible and availably so traverse it
-                child.node->accept(*this);
-                return;
-            }
-            else if (databasePager)
-            {
-                auto priority = rf / cutoff;
-                exchange_if_greater(plod.priority, priority);
-
-                auto previousRequestCount = plod.requestCount.fetch_add(1);
-                if (previousRequestCount == 0)
-                {
-                    // we are first request so tell the databasePager about it
-                    databasePager->request(ref_ptr<PagedLOD>(const_cast<PagedLOD*>(&plod)));
-                }
-                else
-                {
-                    //std::cout<<"repeat request "<<&plod<<", "<<plod.requestCount.load()<<std::endl;;
-                }
-            }
-        }
-        else
-        {
-            if (culledPagedLODs && ((frameCount - plod.frameHighResLastUsed) <= 1))
-            {
-                culledPagedLODs->highresCulled.emplace_back(&plod);
-            }
-        }
-    }
-
-    // check the low res child to see if it's visible
-    {
-        const auto& child = plod.getChild(1);
-        auto cutoff = child.minimumScreenHeightRatio * distance;
-        bool child_visible = rf > cutoff;
-        if (child_visible)
-        {
-            if (child.node)
-            {
-                child.node->accept(*this);
-            }
-        }
-    }
+    traversePagedLOD(*this, plod);
 }
 
 void RecordTraversal::apply(const CullGroup& cullGroup)
@@ -232,6 +158,25 @@ void RecordTraversal::apply(const CullNode& cullNode)
 #endif
 }
 
+void RecordTraversal::apply(const BatchCullGroup& batchCullGroup)
+{
+    auto numChildren = static_cast<uint32_t>(batchCullGroup.getNumChildren());
+    if (numChildren == 0) return;
+
+    // test all the children's bounding spheres in one batch, then only visit the visible children
+    size_t begin = _visibleIndices.size();
+    _visibleIndices.resize(begin + numChildren);
+    uint32_t numVisible = state->intersect(batchCullGroup.getCenterX(), batchCullGroup.getCenterY(), batchCullGroup.getCenterZ(), batchCullGroup.getRadius(), numChildren, _visibleIndices.data() + begin);
+    _visibleIndices.resize(begin + numVisible);
+
+    for (uint32_t i = 0; i < numVisible; ++i)
+    {
+        batchCullGroup.getChild(_visibleIndices[begin + i])->accept(*this);
+    }
+
+    _visibleIndices.resize(begin);
+}
+
 void RecordTraversal::apply(const StateGroup& stateGroup)
 {
     //    std::cout<<"Visiting StateGroup "<<std::endl;
@@ -294,3 +239,69 @@ void RecordTraversal::apply(const Command& command)
     state->dispatch();
     command.dispatch(*(state->_commandBuffer));
 }
+
+void RecordTraversal::apply(const DrawList& drawList)
+{
+    auto& commandBuffer = *(state->_commandBuffer);
+
+    const uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+    std::vector<const StateCommand*> bound(drawList.numSlots, nullptr);
+    uint32_t matrixIndex = invalidIndex;
+
+    // the DrawList's modelview matrices replace the top of the stack for the duration of the DrawList
+    state->modelviewMatrixStack.push(state->modelviewMatrixStack.top());
+    state->projectionMatrixStack.dirty = true;
+
+    auto record = [&](const DrawList::DrawItems& drawItems) {
+        for (auto& drawItem : drawItems)
+        {
+            // the Commands of a DrawItem are recorded together in scene graph order so that binds stay with the draws that use them
+            auto drawCommandsEnd = drawList.drawCommands.begin() + drawItem.first + drawItem.count;
+            for (auto itr = drawList.drawCommands.begin() + drawItem.first; itr != drawCommandsEnd; ++itr)
+            {
+                const StateCommand* const* stateCommands = drawList.stateCommands.data() + itr->stateIndex;
+                for (uint32_t slot = 0; slot < drawList.numSlots; ++slot)
+                {
+                    auto stateCommand = stateCommands[slot];
+                    if (stateCommand && stateCommand != bound[slot])
+                    {
+                        stateCommand->dispatch(commandBuffer);
+                        bound[slot] = stateCommand;
+
+                        // push constants need to be dispatched again for the new pipeline layout
+                        if (slot == 0)
+                        {
+                            state->projectionMatrixStack.dirty = true;
+                            state->modelviewMatrixStack.dirty = true;
+                        }
+                    }
+                }
+
+                if (itr->matrixIndex != matrixIndex)
+                {
+                    matrixIndex = itr->matrixIndex;
+                    state->modelviewMatrixStack.matrixStack.top() = drawList.modelviewMatrices[matrixIndex];
+                    state->modelviewMatrixStack.dirty = true;
+                }
+
+                state->projectionMatrixStack.dispatch(commandBuffer);
+                state->modelviewMatrixStack.dispatch(commandBuffer);
+
+                itr->command->dispatch(commandBuffer);
+            }
+        }
+    };
+
+    record(drawList.opaqueBin);
+    record(drawList.transparentBin);
+
+    state->modelviewMatrixStack.pop();
+
+    // the state bound by the DrawList no longer matches the state stacks, so dispatch them again before the next Command
+    for (auto& stateStack : state->stateStacks)
+    {
+        stateStack.dirty = stateStack.size() > 0;
+    }
+    state->projectionMatrixStack.dirty = true;
+    state->dirty = true;
+}
@@ -55,7 +55,7 @@ void CommandGraph::record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameS
 
     recordTraversal->frameStamp = frameStamp;
     recordTraversal->databasePager = databasePager;
-    if (databasePager) recordTraversal->culledPagedLODs = databasePager->culledPagedLODs;
+    if (databasePager) recordTraversal->culledPagedLODs = culledPagedLODs ? culledPagedLODs : databasePager->culledPagedLODs;
 
     ref_ptr<CommandBuffer> commandBuffer;
     for (auto& cb : commandBuffers)
@@ -87,6 +87,10 @@ void CommandGraph::record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameS
 
     vkBeginCommandBuffer(vk_commandBuffer, &beginInfo);
 
+    // nothing is bound at the start of recording, so redundant binds can be tracked and skipped from here on
+    commandBuffer->resetBoundState();
+    commandBuffer->elideRedundantBinds = true;
+
     accept(*recordTraversal);
 
     vkEndCommandBuffer(vk_commandBuffer);
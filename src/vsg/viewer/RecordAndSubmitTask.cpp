@@ -18,6 +18,107 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 using namespace vsg;
 
 #include <iostream>
+#include <set>
+
+RecordAndSubmitTask::~RecordAndSubmitTask()
+{
+    _stopThreads();
+}
+
+void RecordAndSubmitTask::_stopThreads()
+{
+    for (auto& recordThread : _recordThreads)
+    {
+        recordThread.operationThreads->stop();
+        if (recordThread.commandGraph->culledPagedLODs == recordThread.culledPagedLODs) recordThread.commandGraph->culledPagedLODs = {};
+    }
+    _recordThreads.clear();
+}
+
+void RecordAndSubmitTask::_recordThreaded(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameStamp> frameStamp)
+{
+    // (re)create the threads if the CommandGraphs or their affinity have changed since the previous frame
+    bool threadsValid = _recordThreads.size() == commandGraphs.size();
+    for (size_t i = 0; threadsValid && i < commandGraphs.size(); ++i)
+    {
+        auto& recordThread = _recordThreads[i];
+        threadsValid = (recordThread.commandGraph == commandGraphs[i]) && (recordThread.affinity.cpus == commandGraphs[i]->affinity.cpus);
+    }
+
+    if (!threadsValid)
+    {
+        _stopThreads();
+
+        // CommandBuffers, and the CommandPool they are allocated from, can't be recorded from several threads at once, so CommandGraphs sharing
+        // a Window's per frame CommandBuffers with an earlier CommandGraph have theirs cleared, CommandGraph::record() then allocates its own.
+        std::set<CommandBuffer*> assignedCommandBuffers;
+        for (auto& commandGraph : commandGraphs)
+        {
+            bool shared = false;
+            for (auto& commandBuffer : commandGraph->commandBuffers)
+            {
+                if (!assignedCommandBuffers.insert(commandBuffer.get()).second) shared = true;
+            }
+            if (shared) commandGraph->commandBuffers.clear();
+        }
+
+        _recordThreads.resize(commandGraphs.size());
+        for (size_t i = 0; i < commandGraphs.size(); ++i)
+        {
+            auto& recordThread = _recordThreads[i];
+            recordThread.commandGraph = commandGraphs[i];
+            recordThread.affinity = commandGraphs[i]->affinity;
+            recordThread.operationThreads = OperationThreads::create(Affinities{recordThread.affinity});
+            recordThread.culledPagedLODs = CulledPagedLODs::create();
+
+            // each CommandGraph reports the PagedLOD it culls to its own container so the RecordTraversals don't contend on the DatabasePager's
+            recordThread.commandGraph->culledPagedLODs = recordThread.culledPagedLODs;
+        }
+
+        if (!_recordLatch) _recordLatch = Latch::create(0);
+    }
+
+    struct RecordOperation : public Operation
+    {
+        RecordOperation(RecordThread& rt, ref_ptr<FrameStamp> fs, ref_ptr<DatabasePager> dp, ref_ptr<Latch> l) :
+            recordThread(rt),
+            frameStamp(fs),
+            databasePager(dp),
+            latch(l) {}
+
+        void run() override
+        {
+            recordThread.commandGraph->record(recordThread.recordedCommandBuffers, frameStamp, databasePager);
+            latch->count_down();
+        }
+
+        RecordThread& recordThread;
+        ref_ptr<FrameStamp> frameStamp;
+        ref_ptr<DatabasePager> databasePager;
+        ref_ptr<Latch> latch;
+    };
+
+    _recordLatch->set(static_cast<int>(_recordThreads.size()));
+
+    for (auto& recordThread : _recordThreads)
+    {
+        recordThread.recordedCommandBuffers.clear();
+        recordThread.operationThreads->add(ref_ptr<Operation>(new RecordOperation(recordThread, frameStamp, databasePager, _recordLatch)));
+    }
+
+    // wait till all the CommandGraphs have been recorded
+    _recordLatch->wait();
+
+    // gather the command buffers in CommandGraph order so the submission matches the serial path
+    for (auto& recordThread : _recordThreads)
+    {
+        recordedCommandBuffers.insert(recordedCommandBuffers.end(), recordThread.recordedCommandBuffers.begin(), recordThread.recordedCommandBuffers.end());
+        recordThread.recordedCommandBuffers.clear();
+
+        if (databasePager) databasePager->culledPagedLODs->append(*recordThread.culledPagedLODs);
+        recordThread.culledPagedLODs->clear();
+    }
+}
 
 VkResult RecordAndSubmitTask::submit(ref_ptr<FrameStamp> frameStamp)
 {
@@ -82,15 +183,20 @@ VkResult RecordAndSubmitTask::submit(ref_ptr<FrameStamp> frameStamp)
         vk_waitStages.emplace_back(semaphore->pipelineStageFlags());
     }
 
-    // TODO : separate thread per commandGraph?
-    //        shoould nested CommandGraph handle their own threads?
-    //        set up of recordedCommandBuffers needs to be done in a thread safe way.
-    //
     // record the commands to the command buffers
     CommandBuffers recordedCommandBuffers;
-    for (auto& commandGraph : commandGraphs)
+    if (threading)
     {
-        commandGraph->record(recordedCommandBuffers, frameStamp, databasePager);
+        _recordThreaded(recordedCommandBuffers, frameStamp);
+    }
+    else
+    {
+        if (!_recordThreads.empty()) _stopThreads();
+
+        for (auto& commandGraph : commandGraphs)
+        {
+            commandGraph->record(recordedCommandBuffers, frameStamp, databasePager);
+        }
     }
 
     // convert VSG CommandBuffer to Vulkan handles and add to the Fence's list of depdendent CommandBuffers
@@ -130,14 +236,6 @@ VkResult RecordAndSubmitTask::submit(ref_ptr<FrameStamp> frameStamp)
         vk_signalSemaphores.emplace_back(*(semaphore));
     }
 
-    // TODO:
-    // must wait for all depedent CommandBuffers to complete before we can submit
-    // use a Latch set to the number of CommangGraph's being recorded and passed on to this numDependentSubmission
-    // need seperate record method?
-    // as soon as the command buffers are all recorded we want to do an immediate numDependentSubmission
-    // use a dedicated thread per RecordAndSubmitTask in?
-    // or use a submit operation triggered directly by Latch?
-
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
@@ -10,7 +10,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/io/DatabasePager.h>
+#include <vsg/maths/transform.h>
+#include <vsg/traversals/CullTraversal.h>
+#include <vsg/traversals/DrawList.h>
 #include <vsg/traversals/RecordTraversal.h>
+#include <vsg/ui/ApplicationEvent.h>
 #include <vsg/viewer/RenderGraph.h>
 #include <vsg/vk/State.h>
 
@@ -132,6 +137,33 @@ void RenderGraph::accept(RecordTraversal& dispatchTraversal) const
         camera->getViewMatrix()->get(viewMatrix);
 
         dispatchTraversal.setProjectionAndViewMatrix(projMatrix, viewMatrix);
+
+        // extrapolate the camera motion so that PagedLOD high res subgraphs can be requested before they are required
+        auto& databasePager = dispatchTraversal.databasePager;
+        dispatchTraversal.prefetch = databasePager && databasePager->prefetchTime > 0.0 && dispatchTraversal.frameStamp;
+        if (dispatchTraversal.prefetch)
+        {
+            auto inverseViewMatrix = inverse(viewMatrix);
+            dvec3 eye(inverseViewMatrix[3][0], inverseViewMatrix[3][1], inverseViewMatrix[3][2]);
+
+            auto& motion = dispatchTraversal.cameraMotions[camera.get()];
+            auto time = dispatchTraversal.frameStamp->time;
+            if (motion.previous_time != time_point() && time > motion.previous_time)
+            {
+                // average the velocity over recent frames to avoid frame time jitter causing spurious prefetch requests
+                double delta = std::chrono::duration<double, std::chrono::seconds::period>(time - motion.previous_time).count();
+                dvec3 velocity = motion.eye_velocity * 0.5 + (eye - motion.previous_eye) * (0.5 / delta);
+                motion.eye_velocity.set(velocity.x, velocity.y, velocity.z);
+            }
+            motion.previous_eye.set(eye.x, eye.y, eye.z);
+            motion.previous_time = time;
+
+            // rotate the world space displacement into eye space
+            dvec3 displacement = motion.eye_velocity * databasePager->prefetchTime;
+            dispatchTraversal.prefetchEyeOffset.set(viewMatrix[0][0] * displacement.x + viewMatrix[1][0] * displacement.y + viewMatrix[2][0] * displacement.z,
+                                                    viewMatrix[0][1] * displacement.x + viewMatrix[1][1] * displacement.y + viewMatrix[2][1] * displacement.z,
+                                                    viewMatrix[0][2] * displacement.x + viewMatrix[1][2] * displacement.y + viewMatrix[2][2] * displacement.z);
+        }
     }
 
     VkCommandBuffer vk_commandBuffer = *(dispatchTraversal.state->_commandBuffer);
@@ -144,6 +176,27 @@ void RenderGraph::accept(RecordTraversal& dispatchTraversal) const
 
     renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassInfo.pClearValues = clearValues.data();
+
+    if (useDrawList)
+    {
+        // cull the children into the DrawList and sort it, so that the recording is decoupled from the scene graph traversal
+        auto& cullTraversal = dispatchTraversal.cullTraversal;
+        if (!cullTraversal) cullTraversal = new CullTraversal;
+
+        cullTraversal->reset(dispatchTraversal);
+        traverse(*cullTraversal);
+        cullTraversal->drawList->sort();
+
+        vkCmdBeginRenderPass(vk_commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        cullTraversal->drawList->accept(dispatchTraversal);
+
+        vkCmdEndRenderPass(vk_commandBuffer);
+        return;
+    }
+
+    if (recordScheduler && _recordSecondaryCommandBuffers(dispatchTraversal, renderPassInfo)) return;
+
     vkCmdBeginRenderPass(vk_commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // traverse the command buffer to place the commands into the command buffer.
@@ -151,3 +204,95 @@ void RenderGraph::accept(RecordTraversal& dispatchTraversal) const
 
     vkCmdEndRenderPass(vk_commandBuffer);
 }
+
+bool RenderGraph::_recordSecondaryCommandBuffers(RecordTraversal& dispatchTraversal, VkRenderPassBeginInfo& renderPassInfo) const
+{
+    // plain Groups don't modify the State, so descend through any with a single child to find the children to split
+    const Children* children = &_children;
+    while (children->size() == 1 && typeid(*(children->front())) == typeid(Group))
+    {
+        children = &(static_cast<const Group*>(children->front().get())->getChildren());
+    }
+
+    size_t numRanges = recordScheduler->getNumThreads() + 1;
+    if (maxRecordRanges > 0) numRanges = std::min(numRanges, static_cast<size_t>(maxRecordRanges));
+    numRanges = std::min(numRanges, children->size());
+    if (numRanges < 2) return false;
+
+    auto primaryCommandBuffer = dispatchTraversal.state->_commandBuffer;
+    auto& secondaryCommandBuffers = dispatchTraversal.secondaryCommandBuffers[{this, primaryCommandBuffer.get()}];
+    while (secondaryCommandBuffers.size() < numRanges)
+    {
+        // each secondary CommandBuffer has its own CommandPool as a CommandPool can't be used from several threads at once
+        auto device = primaryCommandBuffer->getDevice();
+        ref_ptr<CommandPool> commandPool = CommandPool::create(device, primaryCommandBuffer->getCommandPool()->getQueueFamilyIndex());
+        ref_ptr<CommandBuffer> commandBuffer = CommandBuffer::create(device, commandPool, VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+        secondaryCommandBuffers.emplace_back(commandBuffer);
+    }
+
+    auto& recordRanges = dispatchTraversal.recordRanges;
+    if (recordRanges.size() < numRanges) recordRanges.resize(numRanges);
+
+    auto recordRange = [&](size_t i) {
+        auto& range = recordRanges[i];
+        if (!range.recordTraversal) range.recordTraversal = new RecordTraversal;
+        if (!range.culledPagedLODs) range.culledPagedLODs = CulledPagedLODs::create();
+
+        auto& recordTraversal = *range.recordTraversal;
+        recordTraversal.frameStamp = dispatchTraversal.frameStamp;
+        recordTraversal.databasePager = dispatchTraversal.databasePager;
+        recordTraversal.culledPagedLODs = dispatchTraversal.culledPagedLODs ? range.culledPagedLODs : ref_ptr<CulledPagedLODs>();
+        recordTraversal.prefetch = dispatchTraversal.prefetch;
+        recordTraversal.prefetchEyeOffset.set(dispatchTraversal.prefetchEyeOffset.x, dispatchTraversal.prefetchEyeOffset.y, dispatchTraversal.prefetchEyeOffset.z);
+
+        auto& commandBuffer = secondaryCommandBuffers[i];
+        recordTraversal.state->inherit(*dispatchTraversal.state);
+        recordTraversal.state->_commandBuffer = commandBuffer;
+
+        VkCommandBufferInheritanceInfo inheritanceInfo = {};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass = renderPassInfo.renderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = renderPassInfo.framebuffer;
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = commandBuffer->flags();
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        vkBeginCommandBuffer(*commandBuffer, &beginInfo);
+        commandBuffer->resetBoundState();
+        commandBuffer->elideRedundantBinds = true;
+
+        size_t begin = (i * children->size()) / numRanges;
+        size_t end = ((i + 1) * children->size()) / numRanges;
+        for (size_t c = begin; c < end; ++c)
+        {
+            (*children)[c]->accept(recordTraversal);
+        }
+
+        vkEndCommandBuffer(*commandBuffer);
+    };
+
+    parallel_for(*recordScheduler, 0, numRanges, 1, recordRange);
+
+    std::vector<VkCommandBuffer> vk_secondaryCommandBuffers;
+    for (size_t i = 0; i < numRanges; ++i)
+    {
+        vk_secondaryCommandBuffers.push_back(*secondaryCommandBuffers[i]);
+
+        auto& range = recordRanges[i];
+        if (dispatchTraversal.culledPagedLODs) dispatchTraversal.culledPagedLODs->append(*range.culledPagedLODs);
+        range.culledPagedLODs->clear();
+    }
+
+    VkCommandBuffer vk_commandBuffer = *primaryCommandBuffer;
+    vkCmdBeginRenderPass(vk_commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(vk_commandBuffer, static_cast<uint32_t>(vk_secondaryCommandBuffers.size()), vk_secondaryCommandBuffers.data());
+
+    // the state bound in the primary command buffer is undefined after executing secondary command buffers
+    primaryCommandBuffer->resetBoundState();
+    vkCmdEndRenderPass(vk_commandBuffer);
+
+    return true;
+}
@@ -381,42 +381,12 @@ void Viewer::update()
 
 void Viewer::recordAndSubmit()
 {
-    // TODO : Seperate thread for each recordAndSubmitTasks?
-    //        Or use a thread pool or local threads specifically for Viewer?
-    //
-    //      How do we manage thread affinity?
-    //          we want threads to have affinity with specific cores
-    //          we want tasks/data to have affinity with specific cores
-    //          affinity favours a single or a thread pool with a specific affinity.
-    //          RecordAndSubmitTask to have user defined affinity
-    //          Operations with that call submit should use the RecordAndSubmitTask affinity
-    //          Operations with affinity to be run on threads/thread pools on specified affinity
-    //
-    //      Should RecordAndSubmitTask (RAS_Task) have it's own Thread pool?
-    //          pros: scales with numer of RAS_Tasks and encapsulates affinity issues
-    //          const: constrains threading to only work within The RAS_Task
-    //
-    //      Do we insert frame syncronization into threads? Or leave this to individual RAS_Tasks ?
-    //          Do we use a Latch to sync the RAS_Task sbumission with subsequent presentation, or just wait within recordAndSubmit?
-    //          Most straight forward would be to have barrier here in the Viewer::recordAndSubmit().
-    //          This would preclude the calling thread from getting on with work while the RAS_Task do their work in background threads
-    //          Start simple and then generalize?
-    //
-    //
-    //      Possible CommandGraph centric approach:
-    //          one thread per CommandGraph
-    //          each thread is assigned an affinity
-    //          require a start record traversal battier so that thread to sleep until new record traversal required
-    //          require record traversal finished barrier to signal completion
-    //          do we use an OperationThraads object per CommandGraph?
-    //          RecordOperation to asssign to OperationThreads?
-    //          Have a single Barrier that is shared between all the CommandGraph traversals that are happening and we need to wait for.
-    //          Use a Latch as a Barrier = each RecordOperation increments the Latch at start, and decrements the Latch on completion
-    //
+    // Each RecordAndSubmitTask can record its CommandGraphs in parallel, one thread per CommandGraph with the thread affinity taken from
+    // CommandGraph::affinity, see RecordAndSubmitTask::threading. The task waits on a Latch for the recording to complete before submitting to its queue.
     //
+    // TODO : run the RecordAndSubmitTasks themselves in parallel?
     //      If we have multiple recordAndSubmit tasks then we'll want to share Barrier's across them and sync after all have been traversed.
     //      What about inter traversal/CommandGraph dependencies?
-    //      Nesting to enforce order?
     //      Order managed in Submissions via VkSemaphore/VkEvent?
     //
     //      Need to create a set of multi-threading test cases to develop for:
@@ -59,6 +59,11 @@ BindIndexBuffer::BindIndexBuffer(Buffer* buffer, VkDeviceSize offset, VkIndexTyp
 }
 
 BindIndexBuffer::~BindIndexBuffer()
+{
+    release();
+}
+
+void BindIndexBuffer::release()
 {
     for (auto& vkd : _vulkanData)
     {
@@ -67,6 +72,7 @@ BindIndexBuffer::~BindIndexBuffer()
             vkd.bufferData._buffer->release(vkd.bufferData._offset, 0); // TODO, we don't locally have a size allocated
         }
     }
+    _vulkanData.clear();
 }
 
 void BindIndexBuffer::read(Input& input)
@@ -109,5 +115,5 @@ void BindIndexBuffer::compile(Context& context)
 void BindIndexBuffer::dispatch(CommandBuffer& commandBuffer) const
 {
     auto& vkd = _vulkanData[commandBuffer.deviceID];
-    vkCmdBindIndexBuffer(commandBuffer, *vkd.bufferData._buffer, vkd.bufferData._offset, vkd.indexType);
+    commandBuffer.bindIndexBuffer(*vkd.bufferData._buffer, vkd.bufferData._offset, vkd.indexType);
 }
@@ -18,6 +18,11 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 using namespace vsg;
 
 BindVertexBuffers::~BindVertexBuffers()
+{
+    release();
+}
+
+void BindVertexBuffers::release()
 {
     for (auto& vkd : _vulkanData)
     {
@@ -30,6 +35,7 @@ BindVertexBuffers::~BindVertexBuffers()
             }
         }
     }
+    _vulkanData.clear();
 }
 
 void BindVertexBuffers::add(ref_ptr<Buffer> buffer, VkDeviceSize offset)
@@ -94,5 +100,5 @@ void BindVertexBuffers::compile(Context& context)
 void BindVertexBuffers::dispatch(CommandBuffer& commandBuffer) const
 {
     auto& vkd = _vulkanData[commandBuffer.deviceID];
-    vkCmdBindVertexBuffers(commandBuffer, _firstBinding, static_cast<uint32_t>(vkd.vkBuffers.size()), vkd.vkBuffers.data(), vkd.offsets.data());
+    commandBuffer.bindVertexBuffers(_firstBinding, static_cast<uint32_t>(vkd.vkBuffers.size()), vkd.vkBuffers.data(), vkd.offsets.data());
 }
@@ -14,11 +14,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 using namespace vsg;
 
-CommandBuffer::CommandBuffer(Device* device, CommandPool* commandPool, VkCommandBuffer commandBuffer, VkCommandBufferUsageFlags flags) :
+CommandBuffer::CommandBuffer(Device* device, CommandPool* commandPool, VkCommandBuffer commandBuffer, VkCommandBufferUsageFlags flags, VkCommandBufferLevel level) :
     deviceID(device->deviceID),
     scratchMemory(ScratchMemory::create(4096)),
     _commandBuffer(commandBuffer),
     _flags(flags),
+    _level(level),
     _device(device),
     _commandPool(commandPool),
     _currentPipelineLayout(0)
@@ -33,7 +34,7 @@ CommandBuffer::~CommandBuffer()
     }
 }
 
-CommandBuffer::Result CommandBuffer::create(Device* device, CommandPool* commandPool, VkCommandBufferUsageFlags flags)
+CommandBuffer::Result CommandBuffer::create(Device* device, CommandPool* commandPool, VkCommandBufferUsageFlags flags, VkCommandBufferLevel level)
 {
     if (!device || !commandPool)
     {
@@ -43,17 +44,138 @@ CommandBuffer::Result CommandBuffer::create(Device* device, CommandPool* command
     VkCommandBufferAllocateInfo allocateInfo = {};
     allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocateInfo.commandPool = *commandPool;
-    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocateInfo.level = level;
     allocateInfo.commandBufferCount = 1;
 
     VkCommandBuffer buffer;
     VkResult result = vkAllocateCommandBuffers(*device, &allocateInfo, &buffer);
     if (result == VK_SUCCESS)
     {
-        return Result(new CommandBuffer(device, commandPool, buffer, flags));
+        return Result(new CommandBuffer(device, commandPool, buffer, flags, level));
     }
     else
     {
         return Result("Error: Failed to create command buffers.", result);
     }
 }
+
+void CommandBuffer::resetBoundState()
+{
+    for (auto& pipeline : _boundPipelines) pipeline = VK_NULL_HANDLE;
+    for (auto& descriptorSets : _boundDescriptorSets) descriptorSets.clear();
+    _boundVertexBuffers.clear();
+    _boundIndexBuffer = VK_NULL_HANDLE;
+
+    bindStatistics = {};
+}
+
+// index of the tracked bind point, or -1 if the bind point isn't tracked
+static int boundIndex(VkPipelineBindPoint bindPoint)
+{
+    if (bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS) return 0;
+    if (bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE) return 1;
+    return -1;
+}
+
+void CommandBuffer::bindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline, VkPipelineLayout pipelineLayout)
+{
+    _currentPipelineLayout = pipelineLayout;
+
+    int index = boundIndex(bindPoint);
+    if (elideRedundantBinds && index >= 0 && _boundPipelines[index] == pipeline)
+    {
+        ++bindStatistics.numPipelineBindsElided;
+        return;
+    }
+
+    vkCmdBindPipeline(_commandBuffer, bindPoint, pipeline);
+    if (index >= 0) _boundPipelines[index] = pipeline;
+    ++bindStatistics.numPipelineBinds;
+}
+
+void CommandBuffer::bindDescriptorSets(VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* descriptorSets)
+{
+    int index = boundIndex(bindPoint);
+    if (index < 0)
+    {
+        vkCmdBindDescriptorSets(_commandBuffer, bindPoint, pipelineLayout, firstSet, descriptorSetCount, descriptorSets, 0, nullptr);
+        ++bindStatistics.numDescriptorSetBinds;
+        return;
+    }
+
+    auto& bound = _boundDescriptorSets[index];
+    uint32_t endSet = firstSet + descriptorSetCount;
+
+    if (elideRedundantBinds && endSet <= bound.size())
+    {
+        bool match = true;
+        for (uint32_t i = 0; i < descriptorSetCount && match; ++i)
+        {
+            match = bound[firstSet + i].descriptorSet == descriptorSets[i] && bound[firstSet + i].pipelineLayout == pipelineLayout;
+        }
+
+        if (match)
+        {
+            ++bindStatistics.numDescriptorSetBindsElided;
+            return;
+        }
+    }
+
+    vkCmdBindDescriptorSets(_commandBuffer, bindPoint, pipelineLayout, firstSet, descriptorSetCount, descriptorSets, 0, nullptr);
+    ++bindStatistics.numDescriptorSetBinds;
+
+    // sets bound with a different pipeline layout may be disturbed by the new binding, so conservatively treat them as unbound
+    if (bound.size() < endSet) bound.resize(endSet);
+    for (auto& boundSet : bound)
+    {
+        if (boundSet.pipelineLayout != pipelineLayout) boundSet = {};
+    }
+    for (uint32_t i = 0; i < descriptorSetCount; ++i)
+    {
+        bound[firstSet + i] = BoundDescriptorSet{pipelineLayout, descriptorSets[i]};
+    }
+}
+
+void CommandBuffer::bindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers, const VkDeviceSize* offsets)
+{
+    uint32_t endBinding = firstBinding + bindingCount;
+    if (elideRedundantBinds && endBinding <= _boundVertexBuffers.size())
+    {
+        bool match = true;
+        for (uint32_t i = 0; i < bindingCount && match; ++i)
+        {
+            match = _boundVertexBuffers[firstBinding + i].buffer == buffers[i] && _boundVertexBuffers[firstBinding + i].offset == offsets[i];
+        }
+
+        if (match)
+        {
+            ++bindStatistics.numVertexBufferBindsElided;
+            return;
+        }
+    }
+
+    vkCmdBindVertexBuffers(_commandBuffer, firstBinding, bindingCount, buffers, offsets);
+    ++bindStatistics.numVertexBufferBinds;
+
+    if (_boundVertexBuffers.size() < endBinding) _boundVertexBuffers.resize(endBinding);
+    for (uint32_t i = 0; i < bindingCount; ++i)
+    {
+        _boundVertexBuffers[firstBinding + i] = BoundVertexBuffer{buffers[i], offsets[i]};
+    }
+}
+
+void CommandBuffer::bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+    if (elideRedundantBinds && _boundIndexBuffer == buffer && _boundIndexBufferOffset == offset && _boundIndexType == indexType)
+    {
+        ++bindStatistics.numIndexBufferBindsElided;
+        return;
+    }
+
+    vkCmdBindIndexBuffer(_commandBuffer, buffer, offset, indexType);
+    ++bindStatistics.numIndexBufferBinds;
+
+    _boundIndexBuffer = buffer;
+    _boundIndexBufferOffset = offset;
+    _boundIndexType = indexType;
+}
@@ -14,10 +14,11 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 using namespace vsg;
 
-CommandPool::CommandPool(VkCommandPool commandPool, Device* device, AllocationCallbacks* allocator) :
+CommandPool::CommandPool(VkCommandPool commandPool, Device* device, AllocationCallbacks* allocator, uint32_t queueFamilyIndex) :
     _commandPool(commandPool),
     _device(device),
-    _allocator(allocator)
+    _allocator(allocator),
+    _queueFamilyIndex(queueFamilyIndex)
 {
 }
 
@@ -48,7 +49,7 @@ CommandPool::Result CommandPool::create(Device* device, uint32_t queueFamilyInde
     VkResult result = vkCreateCommandPool(*device, &poolInfo, allocator, &commandPool);
     if (result == VK_SUCCESS)
     {
-        return Result(new CommandPool(commandPool, device, allocator));
+        return Result(new CommandPool(commandPool, device, allocator, queueFamilyIndex));
     }
     else
     {
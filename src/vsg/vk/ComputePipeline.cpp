@@ -140,8 +140,7 @@ void BindComputePipeline::write(Output& output) const
 
 void BindComputePipeline::dispatch(CommandBuffer& commandBuffer) const
 {
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline->vk(commandBuffer.deviceID));
-    commandBuffer.setCurrentPipelineLayout(_pipeline->getPipelineLayout()->vk(commandBuffer.deviceID));
+    commandBuffer.bindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline->vk(commandBuffer.deviceID), _pipeline->getPipelineLayout()->vk(commandBuffer.deviceID));
 }
 
 void BindComputePipeline::compile(Context& context)
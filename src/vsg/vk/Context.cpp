@@ -45,6 +45,8 @@ MemoryBufferPools::MemoryBufferPools(const std::string& in_name, Device* in_devi
 
 VkDeviceSize MemoryBufferPools::computeMemoryTotalAvailble() const
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     VkDeviceSize totalAvailableSize = 0;
     for (auto& deviceMemory : memoryPools)
     {
@@ -55,6 +57,8 @@ VkDeviceSize MemoryBufferPools::computeMemoryTotalAvailble() const
 
 VkDeviceSize MemoryBufferPools::computeMemoryTotalReserved() const
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     VkDeviceSize totalReservedSize = 0;
     for (auto& deviceMemory : memoryPools)
     {
@@ -65,6 +69,8 @@ VkDeviceSize MemoryBufferPools::computeMemoryTotalReserved() const
 
 VkDeviceSize MemoryBufferPools::computeBufferTotalAvailble() const
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     VkDeviceSize totalAvailableSize = 0;
     for (auto& buffer : bufferPools)
     {
@@ -75,6 +81,8 @@ VkDeviceSize MemoryBufferPools::computeBufferTotalAvailble() const
 
 VkDeviceSize MemoryBufferPools::computeBufferTotalReserved() const
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     VkDeviceSize totalReservedSize = 0;
     for (auto& buffer : bufferPools)
     {
@@ -85,6 +93,8 @@ VkDeviceSize MemoryBufferPools::computeBufferTotalReserved() const
 
 BufferData MemoryBufferPools::reserveBufferData(VkDeviceSize totalSize, VkDeviceSize alignment, VkBufferUsageFlags bufferUsageFlags, VkSharingMode sharingMode, VkMemoryPropertyFlags memoryProperties)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     BufferData bufferData;
     for (auto& bufferFromPool : bufferPools)
     {
@@ -209,6 +219,8 @@ BufferData MemoryBufferPools::reserveBufferData(VkDeviceSize totalSize, VkDevice
 
 MemoryBufferPools::DeviceMemoryOffset MemoryBufferPools::reserveMemory(VkMemoryRequirements memRequirements, VkMemoryPropertyFlags memoryProperties, void* pNextAllocInfo)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     VkDeviceSize totalSize = memRequirements.size;
 
     ref_ptr<DeviceMemory> deviceMemory;
@@ -598,11 +610,13 @@ Context::Context(const Context& context) :
     viewport(context.viewport),
     descriptorPool(context.descriptorPool),
     graphicsQueue(context.graphicsQueue),
-    commandPool(context.commandPool),
     deviceMemoryBufferPools(context.deviceMemoryBufferPools),
     stagingMemoryBufferPools(context.stagingMemoryBufferPools),
     scratchBufferSize(context.scratchBufferSize)
 {
+    // a VkCommandPool must only be used from one thread at a time, so give each copy its own pool as copies are used by separate compile threads
+    if (context.commandPool) commandPool = CommandPool::create(device, context.commandPool->getQueueFamilyIndex());
+
     scratchMemory = ScratchMemory::create(4096);
 }
 
@@ -85,6 +85,18 @@ void DescriptorBuffer::compile(Context& context)
     }
 }
 
+void DescriptorBuffer::release()
+{
+    // buffers assigned directly rather than created from the DataList can't be recreated by compile()
+    if (_dataList.empty()) return;
+
+    for (auto& bufferData : _bufferDataList)
+    {
+        bufferData.release();
+    }
+    _bufferDataList.clear();
+}
+
 void DescriptorBuffer::assignTo(Context& context, VkWriteDescriptorSet& wds) const
 {
     Descriptor::assignTo(context, wds);
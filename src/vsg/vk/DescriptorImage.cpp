@@ -87,6 +87,11 @@ void DescriptorImage::compile(Context& context)
     }
 }
 
+void DescriptorImage::release()
+{
+    _vulkanData.clear();
+}
+
 void DescriptorImage::assignTo(Context& context, VkWriteDescriptorSet& wds) const
 {
     Descriptor::assignTo(context, wds);
@@ -206,7 +206,7 @@ void BindDescriptorSets::compile(Context& context)
 void BindDescriptorSets::dispatch(CommandBuffer& commandBuffer) const
 {
     auto& vkd = _vulkanData[commandBuffer.deviceID];
-    vkCmdBindDescriptorSets(commandBuffer, _bindPoint, vkd._vkPipelineLayout, _firstSet, static_cast<uint32_t>(vkd._vkDescriptorSets.size()), vkd._vkDescriptorSets.data(), 0, nullptr);
+    commandBuffer.bindDescriptorSets(_bindPoint, vkd._vkPipelineLayout, _firstSet, static_cast<uint32_t>(vkd._vkDescriptorSets.size()), vkd._vkDescriptorSets.data());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -261,5 +261,5 @@ void BindDescriptorSet::dispatch(CommandBuffer& commandBuffer) const
 {
     auto& vkd = _vulkanData[commandBuffer.deviceID];
 
-    vkCmdBindDescriptorSets(commandBuffer, _bindPoint, vkd._vkPipelineLayout, _firstSet, 1, &(vkd._vkDescriptorSet), 0, nullptr);
+    commandBuffer.bindDescriptorSets(_bindPoint, vkd._vkPipelineLayout, _firstSet, 1, &(vkd._vkDescriptorSet));
 }
@@ -191,8 +191,7 @@ void BindGraphicsPipeline::write(Output& output) const
 
 void BindGraphicsPipeline::dispatch(CommandBuffer& commandBuffer) const
 {
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->vk(commandBuffer.deviceID));
-    commandBuffer.setCurrentPipelineLayout(_pipeline->getPipelineLayout()->vk(commandBuffer.deviceID));
+    commandBuffer.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->vk(commandBuffer.deviceID), _pipeline->getPipelineLayout()->vk(commandBuffer.deviceID));
 }
 
 void BindGraphicsPipeline::compile(Context& context)
@@ -157,6 +157,8 @@ ImageData vsg::transferImageData(Context& context, const Data* data, Sampler* sa
         return ImageData();
     }
 
+    context.deviceMemoryReserved += memRequirements.size;
+
     textureImage->bind(deviceMemory, offset);
 
     VkImageViewCreateInfo createInfo = {};
@@ -0,0 +1,149 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+
+#include <vsg/io/stream.h>
+#include <vsg/utils/CommandLine.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// StressTest provides the command line settings, invariant checks, failure watchdog and throughput/latency reporting shared by the threading stress tests.
+// Each test runs its scenarios across 2, 4, 8, ... up to the maximum number of threads, and returns a non zero exit code if any check fails or a scenario
+// doesn't complete within the timeout, so that a deadlock fails the test rather than hanging it.
+class StressTest
+{
+public:
+    StressTest(const std::string& in_name, int* argc, char** argv) :
+        name(in_name),
+        arguments(argc, argv)
+    {
+        uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+        // always run with at least 4 threads so that there is contention even on machines with few cores
+        maxThreads = std::max(arguments.value(std::max(hardwareThreads, 4u), "--max-threads"), 2u);
+        iterations = arguments.value(iterations, "--iterations");
+        timeout = arguments.value(timeout, "--timeout");
+
+        for (uint32_t numThreads = 2; numThreads < maxThreads; numThreads *= 2) threadCounts.push_back(numThreads);
+        threadCounts.push_back(maxThreads);
+
+        std::cout << std::fixed << std::setprecision(3);
+    }
+
+    std::string name;
+    vsg::CommandLine arguments;
+    uint32_t maxThreads = 4;
+    uint32_t iterations = 100000;
+    double timeout = 60.0; // seconds allowed for each scenario
+    std::vector<uint32_t> threadCounts;
+    uint32_t numFailures = 0;
+
+    /// record a failure if condition is false.
+    bool check(bool condition, const std::string& scenario, const std::string& message)
+    {
+        if (!condition)
+        {
+            std::cout << "FAILED " << name << " " << scenario << ": " << message << std::endl;
+            ++numFailures;
+        }
+        return condition;
+    }
+
+    /// run scenario() with a watchdog that fails the test if it doesn't return within the timeout.
+    template<typename F>
+    void run(const std::string& scenario, F function)
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool completed = false;
+
+        std::thread watchdog([&]() {
+            std::unique_lock lock(mutex);
+            if (!cv.wait_for(lock, std::chrono::duration<double>(timeout), [&]() { return completed; }))
+            {
+                std::cout << "FAILED " << name << " " << scenario << ": not completed within " << timeout << "s, deadlocked or lost wake up" << std::endl;
+                std::_Exit(2);
+            }
+        });
+
+        function();
+
+        {
+            std::scoped_lock lock(mutex);
+            completed = true;
+        }
+        cv.notify_one();
+        watchdog.join();
+    }
+
+    void reportThroughput(const std::string& scenario, uint32_t numThreads, uint64_t count, double seconds) const
+    {
+        std::cout << "    " << std::setw(40) << std::left << scenario << std::right << " threads " << std::setw(3) << numThreads << "  " << std::setw(14) << (seconds > 0.0 ? static_cast<double>(count) / seconds : 0.0) << " per second" << std::endl;
+    }
+
+    /// report the median, 99th percentile and maximum of latencies in microseconds.
+    void reportLatency(const std::string& scenario, std::vector<double> latencies) const
+    {
+        if (latencies.empty()) return;
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double ratio) { return latencies[static_cast<size_t>(ratio * static_cast<double>(latencies.size() - 1))]; };
+        std::cout << "    " << std::setw(40) << std::left << scenario << std::right << " median " << percentile(0.5) << "us, 99th percentile " << percentile(0.99) << "us, maximum " << latencies.back() << "us" << std::endl;
+    }
+
+    /// report the process CPU time used by blocked threads whilst the calling thread sleeps for the given duration.
+    void reportIdleCost(const std::string& scenario, double seconds) const
+    {
+        auto start = std::clock();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        double cpuSeconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        std::cout << "    " << std::setw(40) << std::left << scenario << std::right << " " << (cpuSeconds * 1000.0) << "ms CPU over " << seconds << "s idle" << std::endl;
+    }
+
+    int result()
+    {
+        if (arguments.errors())
+        {
+            arguments.writeErrorMessages(std::cerr);
+            return 1;
+        }
+
+        if (numFailures > 0)
+        {
+            std::cout << name << " " << numFailures << " checks failed" << std::endl;
+            return 1;
+        }
+        std::cout << name << " passed" << std::endl;
+        return 0;
+    }
+};
+
+inline double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline double microsecondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
@@ -0,0 +1,165 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/Barrier.h>
+#include <vsg/threading/Latch.h>
+
+#include "StressTest.h"
+
+// stress test the Futex based Latch and Barrier, checking that wait() and arrive_and_wait() never return early and always return,
+// and report their wake up latency and the CPU used by threads blocked on them.
+
+void testLatch(StressTest& test, uint32_t numThreads)
+{
+    uint32_t numIterations = std::max(test.iterations / 100, 1u);
+
+    // the workers wait for each iteration's start latch then count down its done latch, the main thread checks that every worker has
+    // incremented the counter by the time its wait on the done latch returns.
+    std::vector<vsg::ref_ptr<vsg::Latch>> startLatches, doneLatches;
+    for (uint32_t i = 0; i < numIterations; ++i)
+    {
+        startLatches.push_back(vsg::Latch::create(1));
+        doneLatches.push_back(vsg::Latch::create(static_cast<int>(numThreads)));
+    }
+
+    std::atomic_uint64_t counter{0};
+
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < numThreads; ++t)
+    {
+        workers.emplace_back([&]() {
+            for (uint32_t i = 0; i < numIterations; ++i)
+            {
+                startLatches[i]->wait();
+                ++counter;
+                doneLatches[i]->count_down();
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t numEarly = 0;
+    for (uint32_t i = 0; i < numIterations; ++i)
+    {
+        startLatches[i]->count_down();
+        doneLatches[i]->wait();
+        if (counter.load() != static_cast<uint64_t>(numThreads) * (i + 1)) ++numEarly;
+    }
+    double seconds = secondsSince(start);
+
+    for (auto& worker : workers) worker.join();
+
+    std::string scenario = vsg::make_string("Latch ", numThreads, " threads");
+    test.check(numEarly == 0, scenario, vsg::make_string("wait() returned before the final count_down() ", numEarly, " times"));
+    test.reportThroughput(scenario + " fork/join", numThreads, numIterations, seconds);
+}
+
+void testBarrier(StressTest& test, uint32_t numThreads)
+{
+    uint32_t numIterations = std::max(test.iterations / 100, 1u);
+
+    auto barrier = vsg::Barrier::create(static_cast<int>(numThreads));
+    std::atomic_uint64_t counter{0};
+    std::atomic_uint64_t numEarly{0};
+
+    auto start = std::chrono::steady_clock::now();
+
+    // each thread increments the counter before arriving, so after generation g every thread must see at least numThreads * (g + 1),
+    // and no more than the threads that have since arrived for the next generation, which doesn't include itself.
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < numThreads; ++t)
+    {
+        threads.emplace_back([&]() {
+            for (uint64_t generation = 0; generation < numIterations; ++generation)
+            {
+                ++counter;
+                barrier->arrive_and_wait();
+
+                auto value = counter.load();
+                if (value < numThreads * (generation + 1) || value >= numThreads * (generation + 2)) ++numEarly;
+            }
+        });
+    }
+
+    for (auto& thread : threads) thread.join();
+    double seconds = secondsSince(start);
+
+    std::string scenario = vsg::make_string("Barrier ", numThreads, " threads");
+    test.check(numEarly.load() == 0, scenario, vsg::make_string("arrive_and_wait() released threads in the wrong generation ", numEarly.load(), " times"));
+    test.check(counter.load() == static_cast<uint64_t>(numThreads) * numIterations, scenario, "arrivals lost");
+    test.reportThroughput(scenario + " generations", numThreads, numIterations, seconds);
+}
+
+void testWakeUpLatency(StressTest& test)
+{
+    using time_point = std::chrono::steady_clock::time_point;
+
+    const size_t numSamples = 200;
+    std::vector<vsg::ref_ptr<vsg::Latch>> latches;
+    for (size_t i = 0; i < numSamples; ++i) latches.push_back(vsg::Latch::create(1));
+
+    std::vector<time_point> released(numSamples);
+    std::vector<double> latencies;
+
+    std::thread waiter([&]() {
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            latches[i]->wait();
+            latencies.push_back(microsecondsBetween(released[i], std::chrono::steady_clock::now()));
+        }
+    });
+
+    // sleep before each count_down() so that the waiter has finished spinning and blocked
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        released[i] = std::chrono::steady_clock::now();
+        latches[i]->count_down();
+    }
+
+    waiter.join();
+
+    test.reportLatency("Latch wake up latency", latencies);
+}
+
+void testIdleCost(StressTest& test)
+{
+    auto latch = vsg::Latch::create(1);
+
+    std::vector<std::thread> waiters;
+    for (uint32_t t = 0; t < test.maxThreads; ++t)
+    {
+        waiters.emplace_back([&]() { latch->wait(); });
+    }
+
+    test.reportIdleCost(vsg::make_string("Latch ", test.maxThreads, " blocked threads"), 1.0);
+
+    latch->count_down();
+    for (auto& waiter : waiters) waiter.join();
+}
+
+int main(int argc, char** argv)
+{
+    StressTest test("vsglatchtest", &argc, argv);
+    if (test.arguments.errors()) return test.result();
+
+    for (auto numThreads : test.threadCounts)
+    {
+        test.run("Latch", [&]() { testLatch(test, numThreads); });
+        test.run("Barrier", [&]() { testBarrier(test, numThreads); });
+    }
+
+    test.run("wake up latency", [&]() { testWakeUpLatency(test); });
+    test.run("idle cost", [&]() { testIdleCost(test); });
+
+    return test.result();
+}
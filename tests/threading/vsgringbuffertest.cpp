@@ -0,0 +1,251 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/OperationQueue.h>
+#include <vsg/threading/RingBuffer.h>
+
+#include "StressTest.h"
+
+// stress test RingBuffer and the OperationQueue built on it with multiple producers and consumers, checking that no entry is lost or duplicated,
+// that each consumer sees each producer's entries in order, that the OperationQueue's overflow preserves every operation, and that blocked consumers exit on shutdown.
+
+void testRingBuffer(StressTest& test, uint32_t numThreads)
+{
+    uint32_t numProducers = std::max(numThreads / 2, 1u);
+    uint32_t numConsumers = std::max(numThreads - numProducers, 1u);
+    uint64_t numPerProducer = test.iterations / numProducers;
+    uint64_t total = numPerProducer * numProducers;
+
+    // a small buffer so that it's frequently full and empty
+    vsg::RingBuffer<uint64_t> buffer(16);
+    std::atomic_bool active{true};
+    std::vector<std::atomic_uint8_t> seen(total);
+    std::atomic_uint64_t numTaken{0};
+    std::atomic_uint64_t numOutOfOrder{0};
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> consumers;
+    for (uint32_t c = 0; c < numConsumers; ++c)
+    {
+        consumers.emplace_back([&]() {
+            std::vector<int64_t> lastSequence(numProducers, -1);
+            uint64_t value = 0;
+            while (buffer.take_when_available(value, active))
+            {
+                uint64_t producer = value / numPerProducer;
+                int64_t sequence = static_cast<int64_t>(value % numPerProducer);
+                if (sequence <= lastSequence[producer]) ++numOutOfOrder;
+                lastSequence[producer] = sequence;
+
+                ++seen[value];
+                ++numTaken;
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back([&, p]() {
+            for (uint64_t i = 0; i < numPerProducer; ++i)
+            {
+                uint64_t value = p * numPerProducer + i;
+                while (!buffer.push(value)) std::this_thread::yield();
+            }
+        });
+    }
+
+    for (auto& producer : producers) producer.join();
+    while (numTaken.load() < total) std::this_thread::yield();
+    double seconds = secondsSince(start);
+
+    active = false;
+    buffer.release();
+    for (auto& consumer : consumers) consumer.join();
+
+    uint64_t numMissing = 0, numDuplicated = 0;
+    for (auto& count : seen)
+    {
+        if (count == 0) ++numMissing;
+        if (count > 1) ++numDuplicated;
+    }
+
+    std::string scenario = vsg::make_string("RingBuffer ", numProducers, " producers, ", numConsumers, " consumers");
+    test.check(numTaken.load() == total, scenario, vsg::make_string("taken ", numTaken.load(), " of ", total));
+    test.check(numMissing == 0 && numDuplicated == 0, scenario, vsg::make_string(numMissing, " missing, ", numDuplicated, " duplicated"));
+    test.check(numOutOfOrder.load() == 0, scenario, vsg::make_string(numOutOfOrder.load(), " taken out of producer order"));
+    test.reportThroughput(scenario, numThreads, total, seconds);
+}
+
+struct CountOperation : public vsg::Inherit<vsg::Operation, CountOperation>
+{
+    CountOperation(std::atomic_uint8_t* in_count) :
+        count(in_count) {}
+
+    void run() override { ++(*count); }
+
+    std::atomic_uint8_t* count;
+};
+
+void testOperationQueue(StressTest& test, uint32_t numThreads)
+{
+    uint32_t numProducers = std::max(numThreads / 2, 1u);
+    uint32_t numConsumers = std::max(numThreads - numProducers, 1u);
+    uint64_t numPerProducer = test.iterations / numProducers;
+    uint64_t total = numPerProducer * numProducers;
+
+    // a small queue so that most of the operations go through the overflow
+    auto active = vsg::Active::create();
+    auto queue = vsg::OperationQueue::create(active, 64);
+    std::vector<std::atomic_uint8_t> runCounts(total);
+    std::atomic_uint64_t numRun{0};
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back([&, p]() {
+            for (uint64_t i = 0; i < numPerProducer; ++i)
+            {
+                queue->add(CountOperation::create(&runCounts[p * numPerProducer + i]));
+            }
+        });
+    }
+
+    std::vector<std::thread> consumers;
+    for (uint32_t c = 0; c < numConsumers; ++c)
+    {
+        consumers.emplace_back([&]() {
+            while (auto operation = queue->take_when_avilable())
+            {
+                operation->run();
+                ++numRun;
+            }
+        });
+    }
+
+    for (auto& producer : producers) producer.join();
+    while (numRun.load() < total) std::this_thread::yield();
+    double seconds = secondsSince(start);
+
+    active->active = false;
+    queue->release();
+    for (auto& consumer : consumers) consumer.join();
+
+    uint64_t numNotRunOnce = 0;
+    for (auto& count : runCounts)
+    {
+        if (count != 1) ++numNotRunOnce;
+    }
+
+    std::string scenario = vsg::make_string("OperationQueue ", numProducers, " producers, ", numConsumers, " consumers");
+    test.check(numNotRunOnce == 0, scenario, vsg::make_string(numNotRunOnce, " operations not run exactly once"));
+    test.reportThroughput(scenario, numThreads, total, seconds);
+}
+
+void testShutdown(StressTest& test, uint32_t numThreads)
+{
+    // consumers blocked on an empty queue must exit promptly once the Active flag is cleared and the queue released
+    auto active = vsg::Active::create();
+    auto queue = vsg::OperationQueue::create(active);
+
+    std::vector<std::thread> consumers;
+    for (uint32_t c = 0; c < numThreads; ++c)
+    {
+        consumers.emplace_back([&]() {
+            while (auto operation = queue->take_when_avilable()) operation->run();
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto start = std::chrono::steady_clock::now();
+    active->active = false;
+    queue->release();
+    for (auto& consumer : consumers) consumer.join();
+    double seconds = secondsSince(start);
+
+    test.check(seconds < 0.5, vsg::make_string("OperationQueue shutdown ", numThreads, " consumers"), vsg::make_string("took ", seconds, "s"));
+}
+
+void testWakeUpLatency(StressTest& test)
+{
+    using time_point = std::chrono::steady_clock::time_point;
+
+    vsg::RingBuffer<time_point> buffer(16);
+    std::atomic_bool active{true};
+    std::vector<double> latencies;
+
+    std::thread consumer([&]() {
+        time_point added;
+        while (buffer.take_when_available(added, active))
+        {
+            latencies.push_back(microsecondsBetween(added, std::chrono::steady_clock::now()));
+        }
+    });
+
+    // sleep between pushes so that the consumer has blocked before each one
+    for (int i = 0; i < 200; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        auto now = std::chrono::steady_clock::now();
+        while (!buffer.push(now)) std::this_thread::yield();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    active = false;
+    buffer.release();
+    consumer.join();
+
+    test.reportLatency("RingBuffer wake up latency", latencies);
+}
+
+void testIdleCost(StressTest& test)
+{
+    vsg::RingBuffer<uint64_t> buffer(16);
+    std::atomic_bool active{true};
+
+    std::vector<std::thread> consumers;
+    for (uint32_t c = 0; c < test.maxThreads; ++c)
+    {
+        consumers.emplace_back([&]() {
+            uint64_t value;
+            while (buffer.take_when_available(value, active)) {}
+        });
+    }
+
+    test.reportIdleCost(vsg::make_string("RingBuffer ", test.maxThreads, " blocked consumers"), 1.0);
+
+    active = false;
+    buffer.release();
+    for (auto& consumer : consumers) consumer.join();
+}
+
+int main(int argc, char** argv)
+{
+    StressTest test("vsgringbuffertest", &argc, argv);
+    if (test.arguments.errors()) return test.result();
+
+    for (auto numThreads : test.threadCounts)
+    {
+        test.run("RingBuffer", [&]() { testRingBuffer(test, numThreads); });
+        test.run("OperationQueue", [&]() { testOperationQueue(test, numThreads); });
+        test.run("shutdown", [&]() { testShutdown(test, numThreads); });
+    }
+
+    test.run("wake up latency", [&]() { testWakeUpLatency(test); });
+    test.run("idle cost", [&]() { testIdleCost(test); });
+
+    return test.result();
+}
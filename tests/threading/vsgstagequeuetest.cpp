@@ -0,0 +1,336 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/Pipeline.h>
+
+#include "StressTest.h"
+
+#include <random>
+
+// stress test StageQueue with concurrent add(), updatePriorities(), take_if() and take_when_available(), checking that no item is lost or duplicated and
+// that a priority queue hands out items highest priority first, and PipelineStage with its concurrency limits changing and items cancelled whilst
+// items flow through the stages, checking that the items out plus those discarded equals the items in.
+
+class TestItem : public vsg::Inherit<vsg::PipelineItem, TestItem>
+{
+public:
+    uint32_t index = 0;
+    std::atomic_uint32_t numTaken{0};
+    std::chrono::steady_clock::time_point added;
+};
+
+using TestQueue = vsg::StageQueue<TestItem>;
+using TestPipeline = vsg::Pipeline<TestItem>;
+using TestStage = vsg::PipelineStage<TestItem>;
+
+std::vector<vsg::ref_ptr<TestItem>> createItems(size_t numItems, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> priorities(0.0, 1.0);
+
+    std::vector<vsg::ref_ptr<TestItem>> items(numItems);
+    for (size_t i = 0; i < numItems; ++i)
+    {
+        items[i] = TestItem::create();
+        items[i]->index = static_cast<uint32_t>(i);
+        items[i]->priority = priorities(random);
+    }
+    return items;
+}
+
+void testStageQueue(StressTest& test, uint32_t numThreads)
+{
+    uint32_t numProducers = std::max(numThreads / 2, 1u);
+    uint32_t numConsumers = std::max(numThreads - numProducers, 1u);
+    size_t numPerProducer = test.iterations / numProducers;
+    size_t total = numPerProducer * numProducers;
+
+    // the items are held here for the duration of the test so that the updating thread can safely pass any of them to updatePriorities()
+    auto items = createItems(total, numThreads);
+
+    auto active = vsg::Active::create();
+    auto queue = TestQueue::create(active, vsg::QueuePolicy::Priority);
+    std::atomic_uint64_t numTaken{0};
+    std::atomic_uint64_t numTakenIf{0};
+    std::atomic_bool producing{true};
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (uint32_t c = 0; c < numConsumers; ++c)
+    {
+        threads.emplace_back([&]() {
+            while (auto item = queue->take_when_available())
+            {
+                ++item->numTaken;
+                ++numTaken;
+            }
+        });
+    }
+
+    // raise the priority of random items and take a fraction of the queued items with take_if(), whilst the items are added and taken
+    std::thread updater([&]() {
+        std::mt19937 random(numThreads);
+        std::uniform_int_distribution<size_t> indices(0, total - 1);
+        std::vector<const TestItem*> increased;
+        while (producing)
+        {
+            increased.clear();
+            for (int i = 0; i < 64; ++i)
+            {
+                auto& item = items[indices(random)];
+                item->priority = item->priority.load() + 1.0;
+                increased.push_back(item.get());
+            }
+            queue->updatePriorities(increased);
+
+            for (auto& item : queue->take_if([](const TestItem* candidate) { return (candidate->index % 31) == 0; }))
+            {
+                ++item->numTaken;
+                ++numTakenIf;
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back([&, p]() {
+            for (size_t i = 0; i < numPerProducer; ++i) queue->add(items[p * numPerProducer + i]);
+        });
+    }
+
+    for (auto& producer : producers) producer.join();
+    while ((numTaken.load() + numTakenIf.load()) < total) std::this_thread::yield();
+    double seconds = secondsSince(start);
+
+    producing = false;
+    updater.join();
+
+    active->active = false;
+    queue->release();
+    for (auto& thread : threads) thread.join();
+
+    size_t numNotTakenOnce = 0;
+    for (auto& item : items)
+    {
+        if (item->numTaken != 1) ++numNotTakenOnce;
+    }
+
+    std::string scenario = vsg::make_string("StageQueue ", numProducers, " producers, ", numConsumers, " consumers");
+    test.check(numNotTakenOnce == 0, scenario, vsg::make_string(numNotTakenOnce, " items not taken exactly once"));
+    test.reportThroughput(scenario, numThreads, total, seconds);
+}
+
+void testPriorityOrder(StressTest& test, uint32_t numThreads)
+{
+    // add from several threads and raise priorities whilst adding, then check the items are taken highest priority first
+    size_t numItems = std::max(test.iterations / 10, 1u);
+    auto items = createItems(numItems, numThreads + 1);
+
+    auto queue = TestQueue::create(vsg::Active::create(), vsg::QueuePolicy::Priority);
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < numThreads; ++p)
+    {
+        producers.emplace_back([&, p]() {
+            std::vector<const TestItem*> increased;
+            for (size_t i = p; i < numItems; i += numThreads)
+            {
+                queue->add(items[i]);
+
+                // raise the priority of an item added earlier by this thread
+                if (i >= numThreads * 8)
+                {
+                    auto& item = items[i - numThreads * 8];
+                    item->priority = item->priority.load() + 0.5;
+                    increased.assign(1, item.get());
+                    queue->updatePriorities(increased);
+                }
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+
+    size_t numOutOfOrder = 0;
+    size_t numTaken = 0;
+    double previousPriority = std::numeric_limits<double>::max();
+    for (auto taken = queue->take(1); !taken.empty(); taken = queue->take(1))
+    {
+        double priority = taken.front()->priority.load();
+        if (priority > previousPriority) ++numOutOfOrder;
+        previousPriority = priority;
+        ++numTaken;
+    }
+
+    std::string scenario = vsg::make_string("StageQueue priority order ", numThreads, " producers");
+    test.check(numTaken == numItems, scenario, vsg::make_string("took ", numTaken, " of ", numItems));
+    test.check(numOutOfOrder == 0, scenario, vsg::make_string(numOutOfOrder, " items taken out of priority order"));
+}
+
+void testPipelineStages(StressTest& test, uint32_t numThreads)
+{
+    size_t numItems = test.iterations;
+    auto items = createItems(numItems, numThreads + 2);
+
+    auto pipeline = TestPipeline::create();
+    auto process = [](TestStage& stage, TestStage::Items& stageItems, uint32_t) {
+        stage.output->add(stageItems);
+    };
+
+    std::atomic_uint64_t numDiscarded{0};
+    for (int s = 0; s < 2; ++s)
+    {
+        auto stage = pipeline->addStage(process, (s == 0) ? vsg::QueuePolicy::Priority : vsg::QueuePolicy::FIFO);
+        stage->maxBatchSize = (s == 0) ? 1 : 8;
+        stage->cancelled = [](const TestItem& item) { return item.cancelled.load(); };
+        stage->discarded = [&](vsg::ref_ptr<TestItem>&) { ++numDiscarded; };
+        stage->setConcurrencyLimit(numThreads);
+    }
+
+    std::atomic_bool flowing{true};
+
+    // raise and lower the stages' concurrency limits, including to 0, and cancel random items, whilst the items flow through the pipeline
+    std::thread controller([&]() {
+        std::mt19937 random(numThreads);
+        std::uniform_int_distribution<uint32_t> limits(0, numThreads);
+        std::uniform_int_distribution<size_t> indices(0, numItems - 1);
+        while (flowing)
+        {
+            for (auto& stage : pipeline->stages) stage->setConcurrencyLimit(limits(random));
+            for (int i = 0; i < 16; ++i) items[indices(random)]->cancelled = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        for (auto& stage : pipeline->stages) stage->setConcurrencyLimit(numThreads);
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& item : items) pipeline->add(item);
+
+    uint64_t numOut = 0;
+    bool flowingStopped = false;
+    while ((numOut + numDiscarded.load()) < numItems)
+    {
+        // once half the items are out, stop changing the concurrency limits and restore them so that the remaining items are processed
+        if (!flowingStopped && numOut > numItems / 2)
+        {
+            flowing = false;
+            flowingStopped = true;
+        }
+
+        for (auto& item : pipeline->output->take_all())
+        {
+            ++item->numTaken;
+            ++numOut;
+        }
+        std::this_thread::yield();
+    }
+    double seconds = secondsSince(start);
+
+    flowing = false;
+    controller.join();
+    pipeline->stop();
+
+    size_t numDuplicated = 0;
+    for (auto& item : items)
+    {
+        if (item->numTaken > 1) ++numDuplicated;
+    }
+
+    std::string scenario = vsg::make_string("PipelineStage ", numThreads, " threads per stage");
+    test.check((numOut + numDiscarded.load()) == numItems, scenario, vsg::make_string("out ", numOut, " + discarded ", numDiscarded.load(), " != in ", numItems));
+    test.check(numDuplicated == 0, scenario, vsg::make_string(numDuplicated, " items output more than once"));
+    test.reportThroughput(scenario, numThreads, numItems, seconds);
+}
+
+void testShutdown(StressTest& test, uint32_t numThreads)
+{
+    // stage threads blocked on empty queues, and those parked by a lowered concurrency limit, must exit promptly when the pipeline is stopped
+    auto pipeline = TestPipeline::create();
+    for (int s = 0; s < 2; ++s)
+    {
+        auto stage = pipeline->addStage([](TestStage& current, TestStage::Items& stageItems, uint32_t) { current.output->add(stageItems); });
+        stage->setConcurrencyLimit(numThreads);
+        stage->setConcurrencyLimit(numThreads / 2);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto start = std::chrono::steady_clock::now();
+    pipeline->stop();
+    double seconds = secondsSince(start);
+
+    test.check(seconds < 0.5, vsg::make_string("Pipeline shutdown ", numThreads, " threads per stage"), vsg::make_string("took ", seconds, "s"));
+}
+
+void testWakeUpLatency(StressTest& test)
+{
+    auto pipeline = TestPipeline::create();
+
+    std::vector<double> latencies;
+    std::mutex mutex;
+    auto stage = pipeline->addStage([&](TestStage&, TestStage::Items& stageItems, uint32_t) {
+        auto now = std::chrono::steady_clock::now();
+        std::scoped_lock lock(mutex);
+        for (auto& item : stageItems) latencies.push_back(microsecondsBetween(item->added, now));
+    });
+    stage->setConcurrencyLimit(test.maxThreads);
+
+    // sleep before each add() so that the stage's threads have blocked
+    const size_t numSamples = 200;
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        auto item = TestItem::create();
+        item->added = std::chrono::steady_clock::now();
+        pipeline->add(item);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pipeline->stop();
+
+    std::scoped_lock lock(mutex);
+    test.reportLatency("PipelineStage wake up latency", latencies);
+}
+
+void testIdleCost(StressTest& test)
+{
+    auto pipeline = TestPipeline::create();
+    auto stage = pipeline->addStage([](TestStage&, TestStage::Items&, uint32_t) {});
+    stage->setConcurrencyLimit(test.maxThreads);
+
+    // half the threads blocked on the empty queue and half parked by the lowered concurrency limit
+    stage->setConcurrencyLimit(test.maxThreads / 2);
+
+    test.reportIdleCost(vsg::make_string("PipelineStage ", test.maxThreads, " idle threads"), 1.0);
+    pipeline->stop();
+}
+
+int main(int argc, char** argv)
+{
+    StressTest test("vsgstagequeuetest", &argc, argv);
+    if (test.arguments.errors()) return test.result();
+
+    for (auto numThreads : test.threadCounts)
+    {
+        test.run("StageQueue", [&]() { testStageQueue(test, numThreads); });
+        test.run("priority order", [&]() { testPriorityOrder(test, numThreads); });
+        test.run("PipelineStage", [&]() { testPipelineStages(test, numThreads); });
+        test.run("shutdown", [&]() { testShutdown(test, numThreads); });
+    }
+
+    test.run("wake up latency", [&]() { testWakeUpLatency(test); });
+    test.run("idle cost", [&]() { testIdleCost(test); });
+
+    return test.result();
+}
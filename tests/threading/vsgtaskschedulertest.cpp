@@ -0,0 +1,223 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/threading/TaskScheduler.h>
+
+#include "StressTest.h"
+
+// stress test the TaskScheduler with nested parallel_for, parallel_reduce and recursive TaskGroup waits checked against the serial results,
+// operations added from outside the scheduler beyond its ring buffer's capacity, and stopping with operations still pending.
+
+void testNestedParallelFor(StressTest& test, vsg::TaskScheduler& scheduler, uint32_t numThreads)
+{
+    const size_t size = 256;
+    uint32_t numIterations = std::max(test.iterations / 10000, 1u);
+
+    uint64_t expected = 0;
+    for (size_t i = 0; i < size; ++i)
+        for (size_t j = 0; j < size; ++j) expected += i * j;
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t numIncorrect = 0;
+    for (uint32_t iteration = 0; iteration < numIterations; ++iteration)
+    {
+        std::atomic_uint64_t sum{0};
+        vsg::parallel_for(scheduler, 0, size, 16, [&](size_t i) {
+            vsg::parallel_for(scheduler, 0, size, 32, [&](size_t j) { sum += i * j; });
+        });
+        if (sum.load() != expected) ++numIncorrect;
+    }
+    double seconds = secondsSince(start);
+
+    std::string scenario = vsg::make_string("nested parallel_for ", numThreads, " workers");
+    test.check(numIncorrect == 0, scenario, vsg::make_string(numIncorrect, " of ", numIterations, " results differ from the serial result"));
+    test.reportThroughput(scenario, numThreads, numIterations * size * size, seconds);
+}
+
+void testParallelReduce(StressTest& test, vsg::TaskScheduler& scheduler, uint32_t numThreads)
+{
+    size_t size = test.iterations;
+    uint64_t expected = static_cast<uint64_t>(size) * (size - 1) / 2;
+
+    auto result = vsg::parallel_reduce(
+        scheduler, 0, size, 1024, uint64_t(0),
+        [](size_t chunk_begin, size_t chunk_end, uint64_t identity) {
+            uint64_t sum = identity;
+            for (size_t i = chunk_begin; i < chunk_end; ++i) sum += i;
+            return sum;
+        },
+        [](uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+
+    test.check(result == expected, vsg::make_string("parallel_reduce ", numThreads, " workers"), vsg::make_string("result ", result, " expected ", expected));
+}
+
+uint64_t fibonacci(vsg::ref_ptr<vsg::TaskScheduler> scheduler, uint32_t n)
+{
+    if (n < 12)
+    {
+        uint64_t a = 0, b = 1;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            uint64_t next = a + b;
+            a = b;
+            b = next;
+        }
+        return a;
+    }
+
+    // waiting on the group from within an operation must run or block on the nested operations without deadlocking the workers
+    uint64_t x = 0, y = 0;
+    auto group = vsg::TaskGroup::create(scheduler);
+    group->add_function([&]() { x = fibonacci(scheduler, n - 1); });
+    group->add_function([&]() { y = fibonacci(scheduler, n - 2); });
+    group->wait();
+    return x + y;
+}
+
+void testRecursiveTaskGroups(StressTest& test, vsg::ref_ptr<vsg::TaskScheduler> scheduler, uint32_t numThreads)
+{
+    auto result = fibonacci(scheduler, 24);
+    test.check(result == 46368, vsg::make_string("recursive TaskGroup ", numThreads, " workers"), vsg::make_string("fibonacci(24) = ", result));
+}
+
+void testExternalAdds(StressTest& test, vsg::ref_ptr<vsg::TaskScheduler> scheduler, uint32_t numThreads)
+{
+    // several threads outside the scheduler add more operations than the scheduler's ring buffer holds, so that its overflow is used
+    const uint32_t numProducers = 2;
+    uint64_t numPerProducer = test.iterations / numProducers;
+    uint64_t total = numPerProducer * numProducers;
+
+    std::vector<std::atomic_uint8_t> runCounts(total);
+    auto group = vsg::TaskGroup::create(scheduler);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back([&, p]() {
+            for (uint64_t i = 0; i < numPerProducer; ++i)
+            {
+                auto count = &runCounts[p * numPerProducer + i];
+                group->add_function([count]() { ++(*count); });
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+
+    group->wait();
+    double seconds = secondsSince(start);
+
+    uint64_t numNotRunOnce = 0;
+    for (auto& count : runCounts)
+    {
+        if (count != 1) ++numNotRunOnce;
+    }
+
+    std::string scenario = vsg::make_string("external add ", numThreads, " workers");
+    test.check(numNotRunOnce == 0, scenario, vsg::make_string(numNotRunOnce, " operations not run exactly once"));
+    test.reportThroughput(scenario, numThreads, total, seconds);
+}
+
+void testStop(StressTest& test, uint32_t numThreads)
+{
+    // stopping with operations still pending, and being added, discards them, TaskGroup::wait() must still return
+    auto scheduler = vsg::TaskScheduler::create(numThreads);
+    auto group = vsg::TaskGroup::create(scheduler);
+
+    const uint32_t numOperations = 10000;
+    std::atomic_uint32_t numRun{0};
+    for (uint32_t i = 0; i < numOperations; ++i)
+    {
+        group->add_function([&]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            ++numRun;
+        });
+    }
+
+    // another thread keeps adding and running operations while the scheduler stops, as a thread in TaskGroup::wait() would, they are discarded once stopped
+    std::atomic_bool stopped{false};
+    std::atomic_uint32_t numAddedRun{0};
+    std::thread adder([&]() {
+        while (!stopped)
+        {
+            group->add_function([&]() { ++numAddedRun; });
+            scheduler->run_one();
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    scheduler->stop();
+    stopped = true;
+    adder.join();
+    group->wait();
+
+    std::string scenario = vsg::make_string("stop ", numThreads, " workers");
+    test.check(group->is_ready(), scenario, "TaskGroup not ready after stop()");
+    test.check(numRun.load() < numOperations, scenario, "all operations run, none were pending when stopped");
+}
+
+void testWakeUpLatency(StressTest& test)
+{
+    using time_point = std::chrono::steady_clock::time_point;
+
+    auto scheduler = vsg::TaskScheduler::create(test.maxThreads);
+    auto group = vsg::TaskGroup::create(scheduler);
+
+    const size_t numSamples = 200;
+    std::vector<double> latencies(numSamples);
+
+    // sleep before each add() so that the workers have blocked
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        time_point added = std::chrono::steady_clock::now();
+        group->add_function([&latencies, added, i]() { latencies[i] = microsecondsBetween(added, std::chrono::steady_clock::now()); });
+    }
+    group->wait();
+
+    scheduler->stop();
+
+    test.reportLatency("TaskScheduler wake up latency", latencies);
+}
+
+void testIdleCost(StressTest& test)
+{
+    auto scheduler = vsg::TaskScheduler::create(test.maxThreads);
+    test.reportIdleCost(vsg::make_string("TaskScheduler ", test.maxThreads, " idle workers"), 1.0);
+    scheduler->stop();
+}
+
+int main(int argc, char** argv)
+{
+    StressTest test("vsgtaskschedulertest", &argc, argv);
+    if (test.arguments.errors()) return test.result();
+
+    for (auto numThreads : test.threadCounts)
+    {
+        auto scheduler = vsg::TaskScheduler::create(numThreads);
+
+        test.run("nested parallel_for", [&]() { testNestedParallelFor(test, *scheduler, numThreads); });
+        test.run("parallel_reduce", [&]() { testParallelReduce(test, *scheduler, numThreads); });
+        test.run("recursive TaskGroup", [&]() { testRecursiveTaskGroups(test, scheduler, numThreads); });
+        test.run("external add", [&]() { testExternalAdds(test, scheduler, numThreads); });
+
+        scheduler->stop();
+
+        test.run("stop", [&]() { testStop(test, numThreads); });
+    }
+
+    test.run("wake up latency", [&]() { testWakeUpLatency(test); });
+    test.run("idle cost", [&]() { testIdleCost(test); });
+
+    return test.result();
+}
@@ -0,0 +1,181 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2018 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/all.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// check that the CullTraversal keeps the BindVertexBuffers and BindIndexBuffer preceding a draw in the same DrawItem as the draw,
+// contiguous and in scene graph order, and that sorting the DrawList moves whole DrawItem rather than separating binds from their draws.
+
+class TestPipeline : public vsg::Inherit<vsg::StateCommand, TestPipeline>
+{
+public:
+    TestPipeline() :
+        Inherit(0) {}
+
+    void dispatch(vsg::CommandBuffer&) const override {}
+};
+
+using Commands = std::vector<const vsg::Command*>;
+
+int numFailures = 0;
+
+void check(bool condition, const std::string& scenario, const std::string& message)
+{
+    if (condition) return;
+
+    std::cout << scenario << " : " << message << std::endl;
+    ++numFailures;
+}
+
+vsg::ref_ptr<vsg::DrawList> cull(vsg::ref_ptr<vsg::Node> scene)
+{
+    // the eye is at the origin looking down the -z axis, so subgraphs at negative z are visible and those at positive z are culled
+    vsg::ref_ptr<vsg::CullTraversal> cullTraversal(new vsg::CullTraversal);
+    cullTraversal->setProjectionAndViewMatrix(vsg::perspective(vsg::radians(60.0), 1.0, 0.1, 1000.0), vsg::dmat4());
+    scene->accept(*cullTraversal);
+    cullTraversal->drawList->sort();
+    return cullTraversal->drawList;
+}
+
+Commands drawItemCommands(const vsg::DrawList& drawList, const vsg::DrawItem& drawItem)
+{
+    Commands commands;
+    for (uint32_t i = drawItem.first; i < drawItem.first + drawItem.count; ++i)
+    {
+        commands.push_back(drawList.drawCommands[i].command);
+    }
+    return commands;
+}
+
+// Group{BindVertexBuffers, BindIndexBuffer, MatrixTransform{DrawIndexed}} under StateGroup with pipelines A, B then A, so the sort moves the third ahead of the second
+void testBindsAroundMatrixTransform()
+{
+    std::string scenario = "binds outside MatrixTransform";
+
+    auto pipelineA = TestPipeline::create();
+    auto pipelineB = TestPipeline::create();
+
+    auto scene = vsg::Group::create();
+    std::vector<Commands> expected;
+    for (auto& pipeline : {pipelineA, pipelineB, pipelineA})
+    {
+        auto bindVertexBuffers = vsg::BindVertexBuffers::create();
+        auto bindIndexBuffer = vsg::BindIndexBuffer::create();
+        auto drawIndexed = vsg::DrawIndexed::create(3, 1, 0, 0, 0);
+
+        auto transform = vsg::MatrixTransform::create(vsg::translate(0.0, 0.0, -10.0));
+        transform->addChild(drawIndexed);
+
+        auto group = vsg::Group::create();
+        group->addChild(bindVertexBuffers);
+        group->addChild(bindIndexBuffer);
+        group->addChild(transform);
+
+        auto stateGroup = vsg::StateGroup::create();
+        stateGroup->add(pipeline);
+        stateGroup->addChild(group);
+        scene->addChild(stateGroup);
+
+        expected.push_back(Commands{bindVertexBuffers.get(), bindIndexBuffer.get(), drawIndexed.get()});
+    }
+
+    auto drawList = cull(scene);
+
+    check(drawList->opaqueBin.size() == 3, scenario, "expected 3 DrawItem, got " + std::to_string(drawList->opaqueBin.size()));
+    if (drawList->opaqueBin.size() != 3) return;
+
+    check(drawItemCommands(*drawList, drawList->opaqueBin[0]) == expected[0], scenario, "first DrawItem doesn't hold the first Group's binds and draw in order");
+    check(drawItemCommands(*drawList, drawList->opaqueBin[1]) == expected[2], scenario, "second DrawItem doesn't hold the third Group's binds and draw in order");
+    check(drawItemCommands(*drawList, drawList->opaqueBin[2]) == expected[1], scenario, "third DrawItem doesn't hold the second Group's binds and draw in order");
+}
+
+// Group{BindVertexBuffers, BindIndexBuffer, CullNode{DrawIndexed}}, the first CullNode is culled so its binds are recorded ahead of the next Group's
+void testBindsOutsideCullNode()
+{
+    std::string scenario = "binds outside CullNode";
+
+    auto scene = vsg::Group::create();
+    std::vector<Commands> groups;
+    for (double z : {10.0, -10.0})
+    {
+        auto bindVertexBuffers = vsg::BindVertexBuffers::create();
+        auto bindIndexBuffer = vsg::BindIndexBuffer::create();
+        auto drawIndexed = vsg::DrawIndexed::create(3, 1, 0, 0, 0);
+
+        auto group = vsg::Group::create();
+        group->addChild(bindVertexBuffers);
+        group->addChild(bindIndexBuffer);
+        group->addChild(vsg::CullNode::create(vsg::dsphere(0.0, 0.0, z, 1.0), drawIndexed));
+        scene->addChild(group);
+
+        groups.push_back(Commands{bindVertexBuffers.get(), bindIndexBuffer.get(), drawIndexed.get()});
+    }
+
+    auto drawList = cull(scene);
+
+    check(drawList->opaqueBin.size() == 1, scenario, "expected 1 DrawItem, got " + std::to_string(drawList->opaqueBin.size()));
+    if (drawList->opaqueBin.size() != 1) return;
+
+    Commands expected{groups[0][0], groups[0][1], groups[1][0], groups[1][1], groups[1][2]};
+    check(drawItemCommands(*drawList, drawList->opaqueBin[0]) == expected, scenario, "DrawItem doesn't hold the binds followed by the visible draw");
+}
+
+// Group{BindVertexBuffers, BindIndexBuffer, DrawIndexed, DrawIndexed} shares the binds between both draws, and a following Commands is recorded as a whole
+void testSharedBindsAndCommands()
+{
+    std::string scenario = "shared binds and Commands";
+
+    auto bindVertexBuffers = vsg::BindVertexBuffers::create();
+    auto bindIndexBuffer = vsg::BindIndexBuffer::create();
+    auto drawIndexed1 = vsg::DrawIndexed::create(3, 1, 0, 0, 0);
+    auto drawIndexed2 = vsg::DrawIndexed::create(3, 1, 3, 0, 0);
+
+    auto group = vsg::Group::create();
+    group->addChild(bindVertexBuffers);
+    group->addChild(bindIndexBuffer);
+    group->addChild(drawIndexed1);
+    group->addChild(drawIndexed2);
+
+    auto commands = vsg::Commands::create();
+    commands->addChild(vsg::BindVertexBuffers::create());
+    commands->addChild(vsg::BindIndexBuffer::create());
+    commands->addChild(vsg::DrawIndexed::create(3, 1, 0, 0, 0));
+
+    auto scene = vsg::MatrixTransform::create(vsg::translate(0.0, 0.0, -10.0));
+    scene->addChild(group);
+    scene->addChild(commands);
+
+    auto drawList = cull(scene);
+
+    check(drawList->opaqueBin.size() == 1, scenario, "expected 1 DrawItem, got " + std::to_string(drawList->opaqueBin.size()));
+    if (drawList->opaqueBin.size() != 1) return;
+
+    // the Commands follows a draw so it may rely on the same binds, and joins its DrawItem as a single Command
+    Commands expected{bindVertexBuffers.get(), bindIndexBuffer.get(), drawIndexed1.get(), drawIndexed2.get(), commands.get()};
+    check(drawItemCommands(*drawList, drawList->opaqueBin[0]) == expected, scenario, "DrawItem doesn't hold the binds followed by both draws and the Commands");
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    testBindsAroundMatrixTransform();
+    testBindsOutsideCullNode();
+    testSharedBindsAndCommands();
+
+    if (numFailures > 0) return 1;
+
+    std::cout << "all DrawList checks passed" << std::endl;
+    return 0;
+}